@@ -0,0 +1,79 @@
+/* occ -- find minimum odd cycle covers (Graph Bipartization)
+   Copyright (C) 2006 Falk Hueffner
+
+   This program is free software; you can redistribute it and/or
+   modify it under the terms of the GNU General Public License as
+   published by the Free Software Foundation; either version 2 of
+   the License, or (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with GCC; see the file COPYING.  If not, write to the Free
+   Software Foundation, 51 Franklin Street, Fifth Floor, Boston, MA
+   02110-1301, USA.  */
+
+#include <stdlib.h>
+
+#include "arena.h"
+
+#define ARENA_ALIGN sizeof (void *)
+#define ARENA_MIN_BLOCK 4096
+
+struct arena_block {
+    struct arena_block *next;
+    void *data[];		// aligned for ARENA_ALIGN
+};
+
+void arena_init(struct arena *arena)
+{
+    arena->blocks = NULL;
+    arena->next = arena->end = NULL;
+    arena->block_size = ARENA_MIN_BLOCK;
+}
+
+void arena_free(struct arena *arena)
+{
+    struct arena_block *b = arena->blocks;
+    while (b)
+    {
+        struct arena_block *next = b->next;
+        free(b);
+        b = next;
+    }
+    arena_init(arena);
+}
+
+void arena_reserve(struct arena *arena, size_t bytes)
+{
+    if ((size_t) (arena->end - arena->next) >= bytes)
+    {
+        return;
+    }
+
+    // Doubling block sizes keep the number of blocks logarithmic.
+    size_t size = arena->block_size;
+    while (size < bytes)
+    {
+        size *= 2;
+    }
+    arena->block_size = 2 * size;
+
+    struct arena_block *b = malloc(sizeof *b + size);
+    b->next = arena->blocks;
+    arena->blocks = b;
+    arena->next = (char *) b->data;
+    arena->end = arena->next + size;
+}
+
+void *arena_alloc(struct arena *arena, size_t bytes)
+{
+    bytes = (bytes + ARENA_ALIGN - 1) & ~(ARENA_ALIGN - 1);
+    arena_reserve(arena, bytes);
+    void *p = arena->next;
+    arena->next += bytes;
+    return p;
+}
@@ -0,0 +1,43 @@
+/* occ -- find minimum odd cycle covers (Graph Bipartization)
+   Copyright (C) 2006 Falk Hueffner
+
+   This program is free software; you can redistribute it and/or
+   modify it under the terms of the GNU General Public License as
+   published by the Free Software Foundation; either version 2 of
+   the License, or (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with GCC; see the file COPYING.  If not, write to the Free
+   Software Foundation, 51 Franklin Street, Fifth Floor, Boston, MA
+   02110-1301, USA.  */
+
+#ifndef ARENA_H
+#define ARENA_H
+
+#include <stddef.h>
+
+/* Bump allocator. Memory comes from a chain of blocks that only grow;
+   nothing is freed individually, and arena_free releases everything
+   at once. Consecutive allocations are adjacent in memory as long as
+   they fit into the current block.  */
+struct arena {
+    struct arena_block *blocks;	// most recent block first
+    char *next, *end;		// free space in the current block
+    size_t block_size;		// size of the next block to allocate
+};
+
+void arena_init(struct arena *arena);
+void arena_free(struct arena *arena);
+
+/* Make sure the next BYTES bytes of allocations come from one block.  */
+void arena_reserve(struct arena *arena, size_t bytes);
+
+/* Return BYTES bytes aligned for any pointer-sized type.  */
+void *arena_alloc(struct arena *arena, size_t bytes);
+
+#endif // ARENA_H
@@ -0,0 +1,58 @@
+#!/bin/sh
+# Compare builds with 16-, 32- and 64-bit vertices: adjacency memory
+# and solve time on the bundled data, and binary size and load time
+# (via --convert) on a large random graph.
+#
+# Usage: bench/vertex-width.sh [VERTICES EDGES]
+# Run from the top of the source tree. Rebuilds occ several times and
+# leaves a default (64-bit) build behind. DATA selects the bundled
+# graphs to solve (default: the Japanese instances, which are quick).
+
+set -e
+
+data=${DATA:-data/japanese/*.graph}
+n=${1:-1000000}
+m=${2:-10000000}
+tmp=${TMPDIR:-/tmp}/occ-bench.$$
+mkdir -p "$tmp"
+trap 'rm -rf "$tmp"' EXIT
+
+# Random graph with numbered vertices.
+awk -v n="$n" -v m="$m" 'BEGIN { srand(1); for (i = 0; i < m; i++)
+    printf "%d %d\n", int(rand() * n), int(rand() * n) }' > "$tmp/random.graph"
+
+for bits in 64 32 16; do
+    make -s clean >/dev/null
+    make -s OCC_VERTEX_BITS=$bits >/dev/null 2>&1
+    cp occ "$tmp/occ-$bits"
+done
+make -s clean
+make -s >/dev/null 2>&1
+
+now() { date +%s.%N; }
+since() { awk -v a="$1" -v b="$(now)" 'BEGIN { printf "%.2f", b - a }'; }
+
+printf '%5s %14s %10s %14s %10s\n' bits data-adjacency data-time random-binary random-load
+for bits in 64 32 16; do
+    occ="$tmp/occ-$bits"
+    bytes=0
+    start=$(now)
+    for f in $data; do
+        b=$("$occ" -v -f "$f" 2>&1 >/dev/null | awk '/bytes of adjacency/ { print $3 }')
+        bytes=$((bytes + b))
+    done
+    data_time=$(since "$start")
+
+    # 16-bit vertices cannot number a large graph.
+    if [ "$bits" = 16 ]; then
+        random_size=-
+        random_time=-
+    else
+        start=$(now)
+        "$occ" --convert "$tmp/random.graph" "$tmp/random.occb"
+        random_time=$(since "$start")
+        random_size=$(wc -c < "$tmp/random.occb")
+    fi
+    printf '%5s %14s %10s %14s %10s\n' "$bits" "$bytes" "$data_time" \
+           "$random_size" "$random_time"
+done
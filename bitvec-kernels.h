@@ -0,0 +1,117 @@
+/* occ -- find minimum odd cycle covers (Graph Bipartization)
+   Copyright (C) 2006 Falk Hueffner
+
+   This program is free software; you can redistribute it and/or
+   modify it under the terms of the GNU General Public License as
+   published by the Free Software Foundation; either version 2 of
+   the License, or (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with GCC; see the file COPYING.  If not, write to the Free
+   Software Foundation, 51 Franklin Street, Fifth Floor, Boston, MA
+   02110-1301, USA.  */
+
+/* Word loops behind the bitvec set operations. This file is included
+   by bitvec.c once per instruction set, with KERNEL(name) giving each
+   function a distinct name and KERNEL_TARGET a target attribute. The
+   loops are written so that the compiler vectorizes them for that
+   target; no intrinsics are needed.  */
+
+KERNEL_TARGET static size_t
+KERNEL(count)(const unsigned long *a, size_t words)
+{
+    size_t count = 0;
+    for (size_t w = 0; w < words; ++w)
+    {
+        count += popcountl(a[w]);
+    }
+    return count;
+}
+
+KERNEL_TARGET static size_t
+KERNEL(count_difference)(const unsigned long *a,
+			 const unsigned long *b, size_t words)
+{
+    size_t count = 0;
+    for (size_t w = 0; w < words; ++w)
+    {
+        count += popcountl(a[w] & ~b[w]);
+    }
+    return count;
+}
+
+KERNEL_TARGET static void
+KERNEL(setminus)(unsigned long *d, const unsigned long *s,
+		 size_t words)
+{
+    for (size_t w = 0; w < words; ++w)
+    {
+        d[w] &= ~s[w];
+    }
+}
+
+KERNEL_TARGET static void
+KERNEL(join)(unsigned long *d, const unsigned long *s,
+	     size_t words)
+{
+    for (size_t w = 0; w < words; ++w)
+    {
+        d[w] |= s[w];
+    }
+}
+
+KERNEL_TARGET static void
+KERNEL(invert)(unsigned long *d, size_t words)
+{
+    for (size_t w = 0; w < words; ++w)
+    {
+        d[w] = ~d[w];
+    }
+}
+
+KERNEL_TARGET static void
+KERNEL(difference)(unsigned long *d, const unsigned long *a,
+		   const unsigned long *b, size_t words)
+{
+    for (size_t w = 0; w < words; ++w)
+    {
+        d[w] = a[w] & ~b[w];
+    }
+}
+
+KERNEL_TARGET static void
+KERNEL(difference_union)(unsigned long *d, const unsigned long *a,
+			 const unsigned long *b,
+			 const unsigned long *c, size_t words)
+{
+    for (size_t w = 0; w < words; ++w)
+    {
+        d[w] = a[w] & ~(b[w] | c[w]);
+    }
+}
+
+KERNEL_TARGET static void
+KERNEL(complement_join)(unsigned long *d, const unsigned long *a,
+			const unsigned long *b, size_t words)
+{
+    for (size_t w = 0; w < words; ++w)
+    {
+        d[w] = ~a[w] | b[w];
+    }
+}
+
+static const struct bitvec_kernels KERNEL(kernels) = {
+    KERNEL(count),
+    KERNEL(count_difference),
+    KERNEL(setminus),
+    KERNEL(join),
+    KERNEL(invert),
+    KERNEL(difference),
+    KERNEL(difference_union),
+    KERNEL(complement_join),
+};
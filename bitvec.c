@@ -22,6 +22,86 @@
 
 #include "bitvec.h"
 
+static inline size_t min(size_t x, size_t y)
+{
+    return x < y ? x : y;
+}
+
+/* The word loops exist in one version per instruction set; the best
+   one the CPU supports is picked at startup.  */
+struct bitvec_kernels {
+    size_t (*count)(const unsigned long *a, size_t words);
+    size_t (*count_difference)(const unsigned long *a, const unsigned long *b,
+			       size_t words);
+    void (*setminus)(unsigned long *d, const unsigned long *s, size_t words);
+    void (*join)(unsigned long *d, const unsigned long *s, size_t words);
+    void (*invert)(unsigned long *d, size_t words);
+    void (*difference)(unsigned long *d, const unsigned long *a,
+		       const unsigned long *b, size_t words);
+    void (*difference_union)(unsigned long *d, const unsigned long *a,
+			     const unsigned long *b, const unsigned long *c,
+			     size_t words);
+    void (*complement_join)(unsigned long *d, const unsigned long *a,
+			    const unsigned long *b, size_t words);
+};
+
+// Baseline: SSE2 on x86-64, whatever the compiler targets elsewhere.
+#define KERNEL(name) name##_generic
+#define KERNEL_TARGET
+#include "bitvec-kernels.h"
+#undef KERNEL
+#undef KERNEL_TARGET
+
+#if defined(__x86_64__) && defined(__GNUC__)
+# define HAVE_KERNEL_DISPATCH
+
+# define KERNEL(name) name##_avx2
+# define KERNEL_TARGET __attribute__((target("avx2,popcnt")))
+# include "bitvec-kernels.h"
+# undef KERNEL
+# undef KERNEL_TARGET
+
+# define KERNEL(name) name##_avx512
+# define KERNEL_TARGET __attribute__((target("avx512f,avx512vpopcntdq,popcnt")))
+# include "bitvec-kernels.h"
+# undef KERNEL
+# undef KERNEL_TARGET
+#endif
+
+static const struct bitvec_kernels *kernels = &kernels_generic;
+
+#ifdef HAVE_KERNEL_DISPATCH
+__attribute__((constructor)) static void select_kernels(void)
+{
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx512f")
+        && __builtin_cpu_supports("avx512vpopcntdq"))
+    {
+        kernels = &kernels_avx512;
+    }
+    else if (__builtin_cpu_supports("avx2")
+             && __builtin_cpu_supports("popcnt"))
+    {
+        kernels = &kernels_avx2;
+    }
+}
+#endif
+
+const char *bitvec_kernel_name(void)
+{
+#ifdef HAVE_KERNEL_DISPATCH
+    if (kernels == &kernels_avx512)
+    {
+        return "avx512";
+    }
+    if (kernels == &kernels_avx2)
+    {
+        return "avx2";
+    }
+#endif
+    return "generic";
+}
+
 struct bitvec* bitvec_make(size_t num_bits)
 {
     struct bitvec *v = calloc(sizeof (struct bitvec) + bitvec_bytes(num_bits), 1);
@@ -82,38 +162,71 @@ size_t bitvec_find(const struct bitvec *v, size_t n)
 
 size_t bitvec_count(const struct bitvec *v)
 {
-    size_t count = 0;
-    for (size_t w = 0; w < bitvec_words(v->num_bits); ++w)
-    {
-        count += popcountl(v->data[w]);
-    }
-
-    return count;
+    return kernels->count(v->data, bitvec_words(v->num_bits));
 }
 
-static inline size_t min(size_t x, size_t y)
+size_t bitvec_count_difference(const struct bitvec *a, const struct bitvec *b)
 {
-    return x < y ? x : y;
+    assert(a->num_bits == b->num_bits);
+    return kernels->count_difference(a->data, b->data, bitvec_words(a->num_bits));
 }
 
 void bitvec_setminus(struct bitvec *d, const struct bitvec *s)
 {
     size_t words = min(bitvec_words(s->num_bits), bitvec_words(d->num_bits));
-    for (size_t w = 0; w < words; ++w)
-    {
-	    d->data[w] &= ~s->data[w];
-    }
+    kernels->setminus(d->data, s->data, words);
 }
 
 void bitvec_join(struct bitvec *d, const struct bitvec *s)
 {
     size_t words = min(bitvec_words(s->num_bits), bitvec_words(d->num_bits));
-    for (size_t w = 0; w < words; ++w)
+    kernels->join(d->data, s->data, words);
+}
+
+/* Bits of D beyond the words written by the fused operations below
+   (if D is longer than the operands) are cleared.  */
+static void clear_tail(struct bitvec *d, size_t words)
+{
+    memset(d->data + words, 0, (bitvec_words(d->num_bits) - words) * sizeof *d->data);
+}
+
+void bitvec_difference(struct bitvec *d, const struct bitvec *a,
+		       const struct bitvec *b)
+{
+    assert(a->num_bits <= b->num_bits && a->num_bits <= d->num_bits);
+    size_t words = bitvec_words(a->num_bits);
+    kernels->difference(d->data, a->data, b->data, words);
+    clear_tail(d, words);
+}
+
+void bitvec_difference_union(struct bitvec *d, const struct bitvec *a,
+			     const struct bitvec *b, const struct bitvec *c)
+{
+    assert(a->num_bits <= b->num_bits && a->num_bits <= c->num_bits
+           && a->num_bits <= d->num_bits);
+    size_t words = bitvec_words(a->num_bits);
+    kernels->difference_union(d->data, a->data, b->data, c->data, words);
+    clear_tail(d, words);
+}
+
+static void clear_padding(struct bitvec *v)
+{
+    size_t words = bitvec_words(v->num_bits);
+    unsigned long padbits = BITS_PER_WORD * words - v->num_bits;
+    if (padbits)
     {
-	    d->data[w] |= s->data[w];
+	    v->data[words - 1] &= ~0UL >> padbits;
     }
 }
 
+void bitvec_complement_join(struct bitvec *d, const struct bitvec *a,
+			    const struct bitvec *b)
+{
+    assert(a->num_bits == d->num_bits && b->num_bits == d->num_bits);
+    kernels->complement_join(d->data, a->data, b->data, bitvec_words(d->num_bits));
+    clear_padding(d);
+}
+
 void bitvec_output(const struct bitvec *v, FILE *stream)
 {
     fprintf(stream, "[%lu/%lu:", (unsigned long) bitvec_count(v), v->num_bits);
@@ -132,25 +245,11 @@ void bitvec_clear(struct bitvec *v)
 void bitvec_fill(struct bitvec *v)
 {
     memset(v->data, (unsigned char) -1, bitvec_bytes(v->num_bits));
-    size_t words = bitvec_words(v->num_bits);
-    unsigned long padbits = BITS_PER_WORD * words - v->num_bits;
-    if (padbits)
-    {
-	    v->data[words - 1] &= ~0UL >> padbits;
-    }
+    clear_padding(v);
 }
 
 void bitvec_invert(struct bitvec *v)
 {
-    size_t words = bitvec_words(v->num_bits);
-
-    for (size_t w = 0; w < words; ++w) {
-	    v->data[w] = ~v->data[w];
-    }
-
-    unsigned long padbits = BITS_PER_WORD * words - v->num_bits;
-    if (padbits)
-    {
-	    v->data[words - 1] &= ~0UL >> padbits;
-    }
+    kernels->invert(v->data, bitvec_words(v->num_bits));
+    clear_padding(v);
 }
@@ -113,6 +113,23 @@ void bitvec_fill(struct bitvec *v);
 void bitvec_invert(struct bitvec *v);
 void bitvec_setminus(struct bitvec *d, const struct bitvec *s);
 void bitvec_join(struct bitvec *d, const struct bitvec *s);
+
+/* Fused operations, each a single pass over the words. */
+// |A \ B|
+size_t bitvec_count_difference(const struct bitvec *a, const struct bitvec *b);
+// D = A \ B
+void bitvec_difference(struct bitvec *d, const struct bitvec *a,
+		       const struct bitvec *b);
+// D = A \ (B u C)
+void bitvec_difference_union(struct bitvec *d, const struct bitvec *a,
+			     const struct bitvec *b, const struct bitvec *c);
+// D = ~A u B
+void bitvec_complement_join(struct bitvec *d, const struct bitvec *a,
+			    const struct bitvec *b);
+
+/* Instruction set of the word loops in use: "avx512", "avx2" or
+   "generic".  */
+const char *bitvec_kernel_name(void);
 void bitvec_output(const struct bitvec *v, FILE *stream);
 static inline void bitvec_dump(const struct bitvec *v) {
     bitvec_output(v, stderr);
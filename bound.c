@@ -0,0 +1,272 @@
+/* occ -- find minimum odd cycle covers (Graph Bipartization)
+   Copyright (C) 2006 Falk Hueffner
+
+   This program is free software; you can redistribute it and/or
+   modify it under the terms of the GNU General Public License as
+   published by the Free Software Foundation; either version 2 of
+   the License, or (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with GCC; see the file COPYING.  If not, write to the Free
+   Software Foundation, 51 Franklin Street, Fifth Floor, Boston, MA
+   02110-1301, USA.  */
+
+#include <stdbool.h>
+#include <stdlib.h>
+
+#include "bitvec.h"
+#include "bound.h"
+#include "csr.h"
+#include "workspace.h"
+
+/* Both packings work in rounds. A round grows a breadth-first forest
+   over the unused vertex codes, collects candidate paths between two
+   codes of the same tree, and takes them shortest first as long as
+   they avoid the codes used so far. That costs one linear search per
+   round, and there are at most as many rounds as packed cycles plus
+   one. For the cycle packing the codes are the vertices of G; for the
+   half-integral packing they are the vertices of the double cover,
+   2 v for v+ and 2 v + 1 for v-.  */
+struct forest {
+    const struct csr *g;
+    bool cover;			// codes are double cover vertices
+    size_t num_codes;
+    struct bitvec *used;
+    struct workspace *ws;	// queue, parents, depths and seen marks
+    vertex *tree;		// root of the tree of each code
+    struct candidate {
+        vertex c, d;
+        vertex depth;		// of the deeper end, for sorting
+    } *candidates;
+    size_t num_candidates, capacity;
+    vertex *path;
+};
+
+static void add_candidate(struct forest *f, vertex c, vertex d)
+{
+    if (f->num_candidates == f->capacity)
+    {
+        f->capacity = f->capacity ? 2 * f->capacity : 64;
+        f->candidates = realloc(f->candidates, f->capacity * sizeof *f->candidates);
+    }
+    const vertex *depth = f->ws->levels;
+    struct candidate *p = &f->candidates[f->num_candidates++];
+    p->c = c;
+    p->d = d;
+    p->depth = depth[c] > depth[d] ? depth[c] : depth[d];
+}
+
+/* Grow the forest. For the cycle packing, every edge inside a level
+   closes an odd cycle and becomes a candidate.  */
+static void grow_forest(struct forest *f)
+{
+    struct workspace *ws = f->ws;
+    vertex *queue = ws->queue, *parent = ws->predecessors, *depth = ws->levels;
+    workspace_begin(ws);
+    f->num_candidates = 0;
+
+    for (size_t root = 0; root < f->num_codes; ++root)
+    {
+        if (bitvec_get(f->used, root) || workspace_marked(ws, ws->visited, root))
+        {
+            continue;
+        }
+        size_t head = 0, tail = 0;
+        workspace_mark(ws, ws->visited, root);
+        parent[root] = root;
+        depth[root] = 0;
+        f->tree[root] = root;
+        queue[tail++] = root;
+        while (head < tail)
+        {
+            vertex c = queue[head++], w;
+            CSR_NEIGHBORS_ITER(f->g, f->cover ? c / 2 : c, w)
+            {
+                vertex d = f->cover ? 2 * w + !(c & 1) : w;
+                if (bitvec_get(f->used, d))
+                {
+                    continue;
+                }
+                if (!workspace_marked(ws, ws->visited, d))
+                {
+                    workspace_mark(ws, ws->visited, d);
+                    parent[d] = c;
+                    depth[d] = depth[c] + 1;
+                    f->tree[d] = root;
+                    queue[tail++] = d;
+                }
+                else if (!f->cover && depth[d] == depth[c] && c < d)
+                {
+                    add_candidate(f, c, d);
+                }
+            }
+        }
+    }
+}
+
+static int by_depth(const void *a, const void *b)
+{
+    vertex x = ((const struct candidate *) a)->depth;
+    vertex y = ((const struct candidate *) b)->depth;
+    return (x > y) - (x < y);
+}
+
+/* Take the tree path between C and D if none of its codes is used.  */
+static bool take_path(struct forest *f, vertex c, vertex d)
+{
+    const vertex *parent = f->ws->predecessors, *depth = f->ws->levels;
+    size_t n = 0;
+    while (c != d)
+    {
+        vertex *deeper = depth[c] >= depth[d] ? &c : &d;
+        if (bitvec_get(f->used, *deeper))
+        {
+            return false;
+        }
+        f->path[n++] = *deeper;
+        *deeper = parent[*deeper];
+    }
+    if (bitvec_get(f->used, c))
+    {
+        return false;
+    }
+    f->path[n++] = c;
+    for (size_t i = 0; i < n; ++i)
+    {
+        bitvec_set(f->used, f->path[i]);
+    }
+    return true;
+}
+
+static size_t pack(struct forest *f)
+{
+    size_t packed = 0;
+    for (;;)
+    {
+        grow_forest(f);
+        if (f->cover)
+        {
+            size_t size = f->num_codes / 2;
+            for (size_t v = 0; v < size; ++v)
+            {
+                if (!bitvec_get(f->used, 2 * v) && !bitvec_get(f->used, 2 * v + 1)
+                    && f->tree[2 * v] == f->tree[2 * v + 1])
+                {
+                    add_candidate(f, 2 * v, 2 * v + 1);
+                }
+            }
+        }
+        qsort(f->candidates, f->num_candidates, sizeof *f->candidates, by_depth);
+
+        size_t taken = 0;
+        for (size_t i = 0; i < f->num_candidates; ++i)
+        {
+            taken += take_path(f, f->candidates[i].c, f->candidates[i].d);
+        }
+        if (taken == 0)
+        {
+            return packed;
+        }
+        packed += taken;
+    }
+}
+
+static void forest_init(struct forest *f, const struct csr *g, bool cover,
+			struct workspace *ws)
+{
+    f->g = g;
+    f->cover = cover;
+    f->num_codes = (cover ? 2 : 1) * csr_size(g);
+    f->used = bitvec_make(f->num_codes);
+    f->ws = ws;
+    f->tree = malloc((f->num_codes ? f->num_codes : 1) * sizeof *f->tree);
+    f->path = malloc((f->num_codes ? f->num_codes : 1) * sizeof *f->path);
+    f->candidates = NULL;
+    f->num_candidates = f->capacity = 0;
+}
+
+static void forest_free(struct forest *f)
+{
+    bitvec_free(f->used);
+    free(f->tree);
+    free(f->path);
+    free(f->candidates);
+}
+
+size_t bound_cycle_packing(const struct csr *g, struct workspace *ws)
+{
+    struct forest f;
+    forest_init(&f, g, false, ws);
+    size_t size = csr_size(g), cycles = 0;
+    struct bitvec *used = f.used;
+
+    // A self-loop is an odd cycle on its own.
+    for (size_t v = 0; v < size; ++v)
+    {
+        vertex w;
+        CSR_NEIGHBORS_ITER(g, v, w)
+        {
+            if (w == v && !bitvec_get(used, v))
+            {
+                bitvec_set(used, v);
+                cycles++;
+            }
+        }
+    }
+
+    // Triangles, by marking the neighbors of each vertex.
+    workspace_begin(ws);
+    for (size_t u = 0; u < size; ++u)
+    {
+        if (bitvec_get(used, u))
+        {
+            continue;
+        }
+        vertex v, w;
+        CSR_NEIGHBORS_ITER(g, u, v)
+        {
+            workspace_mark(ws, ws->seen, v);
+        }
+        CSR_NEIGHBORS_ITER(g, u, v)
+        {
+            if (v <= u || bitvec_get(used, v))
+            {
+                continue;
+            }
+            CSR_NEIGHBORS_ITER(g, v, w)
+            {
+                if (w > v && !bitvec_get(used, w) && workspace_marked(ws, ws->seen, w))
+                {
+                    bitvec_set(used, u);
+                    bitvec_set(used, v);
+                    bitvec_set(used, w);
+                    cycles++;
+                    break;
+                }
+            }
+            if (bitvec_get(used, u))
+            {
+                break;
+            }
+        }
+        workspace_begin(ws);
+    }
+
+    cycles += pack(&f);
+    forest_free(&f);
+    return cycles;
+}
+
+size_t bound_half_packing(const struct csr *g, struct workspace *ws)
+{
+    struct forest f;
+    forest_init(&f, g, true, ws);
+    size_t paths = pack(&f);
+    forest_free(&f);
+    return paths;
+}
@@ -0,0 +1,46 @@
+/* occ -- find minimum odd cycle covers (Graph Bipartization)
+   Copyright (C) 2006 Falk Hueffner
+
+   This program is free software; you can redistribute it and/or
+   modify it under the terms of the GNU General Public License as
+   published by the Free Software Foundation; either version 2 of
+   the License, or (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with GCC; see the file COPYING.  If not, write to the Free
+   Software Foundation, 51 Franklin Street, Fifth Floor, Boston, MA
+   02110-1301, USA.  */
+
+#ifndef BOUND_H
+#define BOUND_H
+
+#include <stddef.h>
+
+struct csr;
+struct workspace;
+
+/* Lower bounds on the size of a minimum odd cycle cover.  */
+
+/* Greedily pack vertex-disjoint odd cycles of G, shortest first, and
+   return their number: every cover needs a vertex of each. Triangles
+   come first; longer cycles are closed by edges inside a level of a
+   breadth-first forest, shallowest first. WS must be reserved for the
+   size of G.  */
+size_t bound_cycle_packing(const struct csr *g, struct workspace *ws);
+
+/* Greedily pack vertex-disjoint paths from v+ to v- in the bipartite
+   double cover of G, which has vertices v+ and v- for each vertex v of
+   G and edges u+ w- and u- w+ for each edge u w. Such a path is an odd
+   closed walk through v, and each vertex of G lies on at most two of
+   them, so weight 1/2 on each gives a fractional odd cycle packing: a
+   solution of the dual of the odd cycle cover LP. Returns the number
+   F of paths; every cover has at least (F + 1) / 2 vertices. WS must
+   be reserved for the size of G.  */
+size_t bound_half_packing(const struct csr *g, struct workspace *ws);
+
+#endif // BOUND_H
@@ -0,0 +1,134 @@
+/* occ -- find minimum odd cycle covers (Graph Bipartization)
+   Copyright (C) 2006 Falk Hueffner
+
+   This program is free software; you can redistribute it and/or
+   modify it under the terms of the GNU General Public License as
+   published by the Free Software Foundation; either version 2 of
+   the License, or (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with GCC; see the file COPYING.  If not, write to the Free
+   Software Foundation, 51 Franklin Street, Fifth Floor, Boston, MA
+   02110-1301, USA.  */
+
+#include <stdbool.h>
+#include <stdlib.h>
+
+#include "components.h"
+#include "csr.h"
+
+#define NULL_VERTEX ((vertex) -1)
+
+static int by_size(const void *a, const void *b)
+{
+    size_t x = csr_size(((const struct component *) a)->g);
+    size_t y = csr_size(((const struct component *) b)->g);
+    return (x < y) - (x > y);
+}
+
+size_t csr_components(const struct csr *g, struct component **components)
+{
+    size_t size = csr_size(g), n = size ? size : 1;
+    vertex *queue = malloc(n * sizeof *queue);
+    vertex *local = malloc(n * sizeof *local);
+    bool *color = malloc(n * sizeof *color);
+    struct component *result = NULL;
+    size_t num = 0, capacity = 0;
+
+    for (size_t v = 0; v < size; ++v)
+    {
+        local[v] = NULL_VERTEX;
+    }
+
+    for (size_t root = 0; root < size; ++root)
+    {
+        if (local[root] != NULL_VERTEX)
+        {
+            continue;
+        }
+
+        // The queue ends up listing the component in search order,
+        // which is also its local numbering.
+        size_t head = 0, tail = 0, arcs = 0;
+        bool bipartite = true;
+        queue[tail] = root;
+        local[root] = tail++;
+        color[root] = false;
+        while (head < tail)
+        {
+            vertex v = queue[head++], w;
+            arcs += csr_degree(g, v);
+            CSR_NEIGHBORS_ITER(g, v, w)
+            {
+                if (local[w] == NULL_VERTEX)
+                {
+                    local[w] = tail;
+                    queue[tail++] = w;
+                    color[w] = !color[v];
+                }
+                else if (color[w] == color[v])
+                {
+                    bipartite = false;
+                }
+            }
+        }
+        if (bipartite)
+        {
+            continue;
+        }
+
+        // A self-loop appears twice in the neighbors of its vertex.
+        vertex (*edges)[2] = malloc((arcs / 2 + 1) * sizeof *edges);
+        size_t m = 0;
+        for (size_t i = 0; i < tail; ++i)
+        {
+            vertex v = queue[i], w;
+            bool loop = false;
+            CSR_NEIGHBORS_ITER(g, v, w)
+            {
+                if (v < w || (v == w && (loop = !loop)))
+                {
+                    edges[m][0] = i;
+                    edges[m][1] = local[w];
+                    m++;
+                }
+            }
+        }
+
+        if (num == capacity)
+        {
+            capacity = capacity ? 2 * capacity : 16;
+            result = realloc(result, capacity * sizeof *result);
+        }
+        result[num].g = csr_make(tail, m, (const vertex (*)[2]) edges);
+        result[num].original = malloc(tail * sizeof (vertex));
+        for (size_t i = 0; i < tail; ++i)
+        {
+            result[num].original[i] = queue[i];
+        }
+        num++;
+        free(edges);
+    }
+
+    free(queue);
+    free(local);
+    free(color);
+    qsort(result, num, sizeof *result, by_size);
+    *components = result;
+    return num;
+}
+
+void components_free(struct component *components, size_t n)
+{
+    for (size_t i = 0; i < n; ++i)
+    {
+        csr_free(components[i].g);
+        free(components[i].original);
+    }
+    free(components);
+}
@@ -0,0 +1,43 @@
+/* occ -- find minimum odd cycle covers (Graph Bipartization)
+   Copyright (C) 2006 Falk Hueffner
+
+   This program is free software; you can redistribute it and/or
+   modify it under the terms of the GNU General Public License as
+   published by the Free Software Foundation; either version 2 of
+   the License, or (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with GCC; see the file COPYING.  If not, write to the Free
+   Software Foundation, 51 Franklin Street, Fifth Floor, Boston, MA
+   02110-1301, USA.  */
+
+#ifndef COMPONENTS_H
+#define COMPONENTS_H
+
+#include <stddef.h>
+
+#include "graph.h"
+
+struct csr;
+
+/* A connected component of a graph as a graph of its own, numbered
+   0 ... size - 1.  */
+struct component {
+    struct csr *g;
+    vertex *original;		// component vertex -> vertex of the graph
+};
+
+/* Split G into its connected components with one breadth-first search
+   that also two-colors them. Bipartite components need no vertex of an
+   odd cycle cover and are dropped. Returns the number of the others,
+   stored in a malloced array at *COMPONENTS in order of decreasing
+   size.  */
+size_t csr_components(const struct csr *g, struct component **components);
+void components_free(struct component *components, size_t n);
+
+#endif // COMPONENTS_H
@@ -0,0 +1,266 @@
+/* occ -- find minimum odd cycle covers (Graph Bipartization)
+   Copyright (C) 2006 Falk Hueffner
+
+   This program is free software; you can redistribute it and/or
+   modify it under the terms of the GNU General Public License as
+   published by the Free Software Foundation; either version 2 of
+   the License, or (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with GCC; see the file COPYING.  If not, write to the Free
+   Software Foundation, 51 Franklin Street, Fifth Floor, Boston, MA
+   02110-1301, USA.  */
+
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+
+#include "bitvec.h"
+#include "csr.h"
+#include "util.h"
+#include "workspace.h"
+
+static struct csr *csr_alloc(size_t size, size_t num_arcs)
+{
+    struct csr *g = malloc(sizeof *g);
+    g->size = size;
+    g->offsets = calloc(size + 1, sizeof *g->offsets);
+    g->neighbors = malloc((num_arcs ? num_arcs : 1) * sizeof *g->neighbors);
+    g->map = NULL;
+    g->map_size = 0;
+    return g;
+}
+
+struct csr *csr_make(size_t size, size_t num_edges, const vertex (*edges)[2])
+{
+    struct csr *g = csr_alloc(size, 2 * num_edges);
+
+    // First pass: degrees, shifted by one so the prefix sum below
+    // leaves offsets[v] at the start of v's block.
+    for (size_t i = 0; i < num_edges; ++i)
+    {
+        assert(edges[i][0] < size && edges[i][1] < size);
+        g->offsets[edges[i][0] + 1]++;
+        g->offsets[edges[i][1] + 1]++;
+    }
+    for (size_t v = 0; v < size; ++v)
+    {
+        g->offsets[v + 1] += g->offsets[v];
+    }
+
+    // Second pass: fill, using offsets[v] as the insertion cursor and
+    // shifting it back afterwards.
+    for (size_t i = 0; i < num_edges; ++i)
+    {
+        vertex v = edges[i][0], w = edges[i][1];
+        g->neighbors[g->offsets[v]++] = w;
+        g->neighbors[g->offsets[w]++] = v;
+    }
+    memmove(g->offsets + 1, g->offsets, size * sizeof *g->offsets);
+    g->offsets[0] = 0;
+
+    return g;
+}
+
+struct parallel_build
+{
+    struct csr *g;
+    size_t num_parts;
+    const size_t *num_edges;
+    vertex (*const *edges)[2];
+    size_t *cursors;
+    size_t *block_sums;
+    unsigned threads;
+};
+
+// Vertex range [*begin, *end) handled by thread i.
+static void vertex_block(size_t size, unsigned threads, unsigned i,
+			 size_t *begin, size_t *end)
+{
+    *begin = size * i / threads;
+    *end = size * (i + 1) / threads;
+}
+
+static void count_degrees(void *arg, unsigned i)
+{
+    struct parallel_build *b = arg;
+    for (size_t part = i; part < b->num_parts; part += b->threads)
+    {
+        for (size_t e = 0; e < b->num_edges[part]; ++e)
+        {
+            __atomic_fetch_add(&b->g->offsets[b->edges[part][e][0] + 1], 1, __ATOMIC_RELAXED);
+            __atomic_fetch_add(&b->g->offsets[b->edges[part][e][1] + 1], 1, __ATOMIC_RELAXED);
+        }
+    }
+}
+
+static void sum_block(void *arg, unsigned i)
+{
+    struct parallel_build *b = arg;
+    size_t begin, end, sum = 0;
+    vertex_block(b->g->size, b->threads, i, &begin, &end);
+    for (size_t v = begin; v < end; ++v)
+    {
+        sum += b->g->offsets[v + 1];
+        b->g->offsets[v + 1] = sum;
+    }
+    b->block_sums[i] = sum;
+}
+
+static void add_block_base(void *arg, unsigned i)
+{
+    struct parallel_build *b = arg;
+    size_t begin, end, base = 0;
+    vertex_block(b->g->size, b->threads, i, &begin, &end);
+    for (unsigned j = 0; j < i; ++j)
+    {
+        base += b->block_sums[j];
+    }
+    for (size_t v = begin; v < end; ++v)
+    {
+        b->g->offsets[v + 1] += base;
+        b->cursors[v] = b->g->offsets[v];
+    }
+}
+
+static void fill_neighbors(void *arg, unsigned i)
+{
+    struct parallel_build *b = arg;
+    for (size_t part = i; part < b->num_parts; part += b->threads)
+    {
+        for (size_t e = 0; e < b->num_edges[part]; ++e)
+        {
+            vertex v = b->edges[part][e][0], w = b->edges[part][e][1];
+            b->g->neighbors[__atomic_fetch_add(&b->cursors[v], 1, __ATOMIC_RELAXED)] = w;
+            b->g->neighbors[__atomic_fetch_add(&b->cursors[w], 1, __ATOMIC_RELAXED)] = v;
+        }
+    }
+}
+
+struct csr *csr_make_parallel(size_t size, size_t num_parts,
+			      const size_t *num_edges,
+			      vertex (*const *edges)[2], unsigned threads)
+{
+    size_t total = 0;
+    for (size_t part = 0; part < num_parts; ++part)
+    {
+        total += num_edges[part];
+    }
+
+    size_t block_sums[threads];
+    struct parallel_build b = {
+        .g          = csr_alloc(size, 2 * total),
+        .num_parts  = num_parts,
+        .num_edges  = num_edges,
+        .edges      = edges,
+        .cursors    = malloc((size ? size : 1) * sizeof *b.cursors),
+        .block_sums = block_sums,
+        .threads    = threads,
+    };
+
+    // Degrees go to offsets[v + 1]; a blocked prefix sum (per-block
+    // sums, then per-block bases) turns them into offsets.
+    run_threads(threads, count_degrees, &b);
+    run_threads(threads, sum_block, &b);
+    run_threads(threads, add_block_base, &b);
+    run_threads(threads, fill_neighbors, &b);
+
+    free(b.cursors);
+    return b.g;
+}
+
+static int vertex_cmp(const void *p1, const void *p2)
+{
+    vertex v = *(const vertex *) p1, w = *(const vertex *) p2;
+    return (v > w) - (v < w);
+}
+
+struct sort_job
+{
+    struct csr *g;
+    unsigned threads;
+};
+
+static void sort_block(void *arg, unsigned i)
+{
+    struct sort_job *job = arg;
+    size_t begin, end;
+    vertex_block(job->g->size, job->threads, i, &begin, &end);
+    for (size_t v = begin; v < end; ++v)
+    {
+        qsort(job->g->neighbors + job->g->offsets[v], csr_degree(job->g, v),
+              sizeof (vertex), vertex_cmp);
+    }
+}
+
+void csr_sort_neighbors(struct csr *g, unsigned threads)
+{
+    struct sort_job job = { g, threads };
+    run_threads(threads, sort_block, &job);
+}
+
+void csr_free(struct csr *g)
+{
+    if (g->map)
+    {
+        munmap(g->map, g->map_size);
+    }
+    else
+    {
+        free(g->offsets);
+        free(g->neighbors);
+    }
+    free(g);
+}
+
+bool csr_two_coloring(const struct csr_view *view, const struct bitvec *omit,
+		      struct bitvec *colors, struct workspace *ws)
+{
+    size_t size = csr_view_size(view);
+    assert(colors->num_bits >= size && view->mask->num_bits == size
+           && ws->capacity >= size);
+    workspace_begin(ws);
+    vertex *queue = ws->queue;
+    vertex *qhead = queue, *qtail = queue;
+
+    for (size_t v0 = 0; v0 < size; ++v0)
+    {
+        // Vertices outside the view or in OMIT are never colored.
+        if (workspace_marked(ws, ws->seen, v0) || !bitvec_get(view->mask, v0)
+            || (omit && bitvec_get(omit, v0)))
+        {
+            continue;
+        }
+        *qtail++ = v0;
+        workspace_mark(ws, ws->seen, v0);
+        do
+        {
+            vertex v = *qhead++, w;
+            bool c = bitvec_get(colors, v);
+            CSR_VIEW_NEIGHBORS_ITER(view, v, w)
+            {
+                if (omit && bitvec_get(omit, w))
+                {
+                    continue;
+                }
+                if (!workspace_marked(ws, ws->seen, w))
+                {
+                    bitvec_put(colors, w, !c);
+                    assert(qtail < queue + size);
+                    *qtail++ = w;
+                    workspace_mark(ws, ws->seen, w);
+                }
+                else if (bitvec_get(colors, w) == c)
+                {
+                    return false;
+                }
+            }
+        } while (qhead != qtail);
+    }
+    return true;
+}
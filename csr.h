@@ -0,0 +1,94 @@
+/* occ -- find minimum odd cycle covers (Graph Bipartization)
+   Copyright (C) 2006 Falk Hueffner
+
+   This program is free software; you can redistribute it and/or
+   modify it under the terms of the GNU General Public License as
+   published by the Free Software Foundation; either version 2 of
+   the License, or (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with GCC; see the file COPYING.  If not, write to the Free
+   Software Foundation, 51 Franklin Street, Fifth Floor, Boston, MA
+   02110-1301, USA.  */
+
+#ifndef CSR_H
+#define CSR_H
+
+#include <assert.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+#include "graph.h"
+
+struct bitvec;
+struct workspace;
+
+/* Read-only graph in compressed sparse row form. The neighbors of v
+   are neighbors[offsets[v]] ... neighbors[offsets[v + 1] - 1]; both
+   arrays are single allocations, so iterating over a neighborhood
+   touches one contiguous block. If MAP is not NULL, the arrays live
+   in a mapped binary graph file of MAP_SIZE bytes instead.  */
+struct csr {
+    size_t size;
+    size_t *offsets;
+    vertex *neighbors;
+    void *map;
+    size_t map_size;
+};
+
+#define CSR_NEIGHBORS_ITER(g, v, w)					\
+    for (const vertex *__pw = (g)->neighbors + (g)->offsets[v],	\
+		      *__pw_end = (g)->neighbors + (g)->offsets[(v) + 1]; \
+	 __pw != __pw_end && (w = *__pw, 1); __pw++)
+
+/* Build a graph on SIZE vertices from NUM_EDGES undirected edges by
+   counting degrees first and then filling the neighbor array.  */
+struct csr *csr_make(size_t size, size_t num_edges, const vertex (*edges)[2]);
+/* The same for edges split into NUM_PARTS arrays, using THREADS
+   threads for degree counting, the prefix sum and the fill. The order
+   within each neighbor list then depends on thread scheduling.  */
+struct csr *csr_make_parallel(size_t size, size_t num_parts,
+			      const size_t *num_edges,
+			      vertex (*const *edges)[2], unsigned threads);
+/* Sort every neighbor list, which makes the result independent of how
+   the graph was built.  */
+void csr_sort_neighbors(struct csr *g, unsigned threads);
+void csr_free(struct csr *g);
+
+static inline size_t csr_size(const struct csr *g) { return g->size; }
+static inline size_t csr_degree(const struct csr *g, vertex v) {
+    assert(v < g->size);
+    return g->offsets[v + 1] - g->offsets[v];
+}
+static inline size_t csr_num_edges(const struct csr *g) {
+    return g->offsets[g->size] / 2;
+}
+
+/* The subgraph of G induced by the vertices in MASK, without a copy.
+   Vertices outside MASK keep their numbers but have no neighbors, so
+   a view has as many vertices as G.  */
+struct csr_view {
+    const struct csr *g;
+    const struct bitvec *mask;
+};
+
+#define CSR_VIEW_NEIGHBORS_ITER(view, v, w)				\
+    CSR_NEIGHBORS_ITER((view)->g, v, w)					\
+	if (!bitvec_get((view)->mask, w)) ; else
+
+static inline size_t csr_view_size(const struct csr_view *view) {
+    return csr_size(view->g);
+}
+
+/* Two-color VIEW minus the vertices in OMIT (which may be NULL).
+   Returns false if that subgraph is not bipartite. WS must be reserved
+   for the size of VIEW.  */
+bool csr_two_coloring(const struct csr_view *view, const struct bitvec *omit,
+		      struct bitvec *colors, struct workspace *ws);
+
+#endif // CSR_H
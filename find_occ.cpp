@@ -4,13 +4,13 @@ bool enum2col   = true;
 bool use_gray   = true;
 struct bitvec *occ = NULL;
 const char **vertices;
+vertex *vertex_map;
 unsigned long long augmentations = 0;
-struct graph *g;
+struct csr *g;
+struct reduction *reduction;
 
-size_t last_index_finished = -1;
 bool run_heuristics = false;
 bool density = false;
-vector<int> remaining_vertices;
 
 
 double user_time(void) {
@@ -20,21 +20,165 @@ double user_time(void) {
 }
 
 
-void find_occ(const struct graph *g, int preprocessing, int seed, long htime)
-{
+// Graphs with numbered vertices have no name table.
+static void print_vertex(size_t v) {
+    if (vertex_map)
+        v = vertex_map[v];
+    if (vertices)
+        puts(vertices[v]);
+    else
+        printf("%lu\n", (unsigned long) v);
+}
 
-    // Determine which optimizations to use
-    if (preprocessing == 1) {
-        run_heuristics = true;
+
+/* One iterative compression pass over the vertices in ORDER, starting
+   from the bipartite subgraph SUB.  */
+struct pass {
+    vector<int> order;
+    struct bitvec *sub;
+    struct bitvec *occ;
+    size_t occ_size;
+    size_t last_index_finished;
+
+    // Size of the cover this pass would output now.
+    size_t upper_bound() const {
+        return occ_size + order.size() - last_index_finished - 1;
     }
-    if (preprocessing == 2) {
-        run_heuristics = true;
-        density = true;
+};
+
+/* State shared by all passes, updated without locks.  Every pass's
+   cover plus its unexplored vertices is a valid OCT set, so the best of
+   these is an upper bound on the optimum.  The compression step is not
+   exact once a cover fails to shrink, so the partial covers give no
+   lower bound; the first pass to reach the end wins and the others
+   stop.  A pass is abandoned early when its partial cover already
+   exceeds the incumbent.  */
+struct shared_bounds {
+    size_t lower;		// odd cycle packing of the whole graph
+    std::atomic<size_t> upper;
+    std::atomic<int> winner;	// first pass to finish, or -1
+};
+
+struct portfolio_run {
+    const struct csr *g;
+    vector<struct pass> *passes;
+    struct shared_bounds *bounds;
+};
+
+static void atomic_min(std::atomic<size_t> &x, size_t value) {
+    size_t old = x.load(std::memory_order_relaxed);
+    while (old > value && !x.compare_exchange_weak(old, value, std::memory_order_relaxed));
+}
+
+static void compress_pass(void *arg, unsigned id) {
+    struct portfolio_run *run = (struct portfolio_run *) arg;
+    struct pass &pass = (*run->passes)[id];
+    struct shared_bounds &bounds = *run->bounds;
+    const struct csr *g = run->g;
+    struct bitvec *sub = pass.sub;
+    struct workspace *ws = workspace_make(g->size);
+    struct bitvec *occ = bitvec_make(g->size);
+    size_t occ_size = 0;
+    pass.occ = occ;
+    pass.occ_size = 0;
+    pass.last_index_finished = -1;
+
+    // G[sub] - occ with its coloring, and the rest of what occ_shrink
+    // needs, kept up to date from step to step.
+    struct csr_view view = { g, sub };
+    struct occ_state *state = occ_state_make(&view, occ);
+
+    // Start compression
+    size_t i = 0;
+    while (!received_timeout && bounds.winner.load(std::memory_order_relaxed) < 0
+           && i < pass.order.size()) {
+
+        // Look up vertex
+        int v = pass.order[i];
+
+        // Add v to the subgraph we're looking at
+	    bitvec_set(sub, v);
+
+        // If this is already an OCT set, continue on. Only the edges
+        // of v can close an odd cycle.
+        pass.last_index_finished = i;
+	    if (occ_state_add(state, &view, occ, v))
+        {
+            // Make sure to increment loop control before continuing.
+            i++;
+	        continue;
+	    }
+        else {
+            bitvec_set(occ, v);
+            occ_size++;
+        }
+
+	    struct bitvec *occ_new = occ_shrink(&view, occ, ws, enum2col, use_gray, true, &received_timeout, state);
+
+        /* If we cannot compress then occ_new is null and we need to keep occ.
+           Otherwise occ should now point to occ_new */
+        if (occ_new)
+        {
+	        free(occ);
+	        occ = occ_new;
+	        occ_size = bitvec_count(occ);
+            if (!occ_is_occ(&view, occ, ws))
+            {
+                fprintf(stderr, "Internal error!\n");
+                abort();
+            }
+	    }
+        pass.occ = occ;
+        pass.occ_size = occ_size;
+
+        // Share the incumbent bound, and abandon this pass once its
+        // partial cover alone is larger than some other pass's output.
+        if (received_timeout) break;
+        atomic_min(bounds.upper, pass.upper_bound());
+        if (occ_size > bounds.upper.load(std::memory_order_relaxed)) break;
+
+        // A cover as small as the lower bound is optimal.
+        if (pass.upper_bound() <= bounds.lower) {
+            int none = -1;
+            bounds.winner.compare_exchange_strong(none, id);
+            break;
+        }
+
+        // Increment i
+        i++;
+
     }
 
-    // Make the occ and subgraph bitvectors
-    occ = bitvec_make(g->size);
-    ALLOCA_BITVEC(sub, g->size);
+    // Having gone through all vertices, this pass is done.
+    if (i == pass.order.size() && !received_timeout) {
+        int none = -1;
+        bounds.winner.compare_exchange_strong(none, id);
+    }
+    occ_state_free(state);
+    workspace_free(ws);
+}
+
+
+/* Run the heuristics and the compression passes on G and return the
+   cover found, including the vertices no pass got to.  */
+static struct bitvec *solve(const struct csr *g, int seed, long htime, size_t *lower)
+{
+    vector<int> remaining_vertices;
+
+    // Lower bounds from vertex-disjoint odd cycles and from the
+    // half-integral packing in the double cover
+    struct workspace *ws = workspace_make(g->size);
+    size_t cycles = bound_cycle_packing(g, ws);
+    size_t half = (bound_half_packing(g, ws) + 1) / 2;
+    *lower = cycles > half ? cycles : half;
+    if (verbose) {
+        fprintf(stderr, "lower bounds: %zu disjoint odd cycles, %zu from the double cover\n",
+                cycles, half);
+    }
+    workspace_free(ws);
+
+    // Make the subgraph bitvector
+    struct bitvec *sub = bitvec_make(g->size);
 
     // If we're running heuristics, compute an initial bipartite subgraph.
     if (run_heuristics) {
@@ -46,11 +190,9 @@ void find_occ(const struct graph *g, int preprocessing, int seed, long htime)
         // Iterate over all vertices
         for (size_t v = 0; v < g->size; v++) {
 
-            // Iterate over all neighbors of vertex v
-            for (size_t n = 0; n < g->vertices[v]->deg; n++) {
-
-                // Get the neighbor w
-                size_t w = g->vertices[v]->neighbors[n];
+            // Iterate over all neighbors w of vertex v
+            vertex w;
+            CSR_NEIGHBORS_ITER(g, v, w) {
 
                 // If we haven't seen this neighbor yet, add
                 // the edge to the heuristics graph.
@@ -63,7 +205,7 @@ void find_occ(const struct graph *g, int preprocessing, int seed, long htime)
         auto heuristic_result = solver.heuristic_solve(heuristics_graph, received_timeout, htime, seed);
         auto heuristic_subgraph = get<0>(heuristic_result);
 
-        // We save heuristic oct globally so it can be used by the SIGTERM handler
+        // The heuristic OCT is compressed vertex by vertex
         remaining_vertices = get<1>(heuristic_result);
 
         // Add all the vertices from the heuristic subgraph to the
@@ -72,6 +214,20 @@ void find_occ(const struct graph *g, int preprocessing, int seed, long htime)
             bitvec_set(sub, v);
         }
 
+        // If the heuristic OCT meets the lower bound, it is optimal.
+        if (remaining_vertices.size() <= *lower) {
+            if (verbose) {
+                fprintf(stderr, "heuristic OCT of size %zu meets the lower bound\n",
+                        remaining_vertices.size());
+            }
+            struct bitvec *cover = bitvec_make(g->size);
+            for (auto v : remaining_vertices) {
+                bitvec_set(cover, v);
+            }
+            bitvec_free(sub);
+            return cover;
+        }
+
         // If we're using density, we want to order the vertices in
         // the oct set so that we iterate over them correctly.
         if (density) {
@@ -126,77 +282,151 @@ void find_occ(const struct graph *g, int preprocessing, int seed, long htime)
         iota(remaining_vertices.begin(), remaining_vertices.end(), 0);
     }
 
-    // If we're not using density sorting, then randomly shuffle remaining_vertices
-    if (!density) {
-        std::shuffle(remaining_vertices.begin(), remaining_vertices.end(), std::default_random_engine(seed));
+    // Pass 0 keeps the order computed above; with a portfolio, the
+    // others shuffle it with their own seeds.
+    unsigned num_passes = portfolio > 0 ? portfolio : 1;
+    vector<struct pass> passes(num_passes);
+    for (unsigned p = 0; p < num_passes; p++) {
+        passes[p].order = remaining_vertices;
+        if (!density || p > 0) {
+            std::shuffle(passes[p].order.begin(), passes[p].order.end(),
+                         std::default_random_engine(seed + p));
+        }
+        passes[p].sub = bitvec_clone(sub);
+    }
+    struct shared_bounds bounds;
+    bounds.lower = *lower;
+    bounds.upper = SIZE_MAX;
+    bounds.winner = -1;
+    struct portfolio_run run = { g, &passes, &bounds };
+    run_threads(num_passes, compress_pass, &run);
+
+    // The pass that finished first, or after a timeout the one with
+    // the smallest cover.
+    size_t best = 0;
+    if (bounds.winner >= 0) {
+        best = bounds.winner;
+    } else {
+        for (size_t p = 1; p < num_passes; p++) {
+            if (passes[p].upper_bound() < passes[best].upper_bound()) best = p;
+        }
+    }
+    if (verbose && num_passes > 1) {
+        fprintf(stderr, "portfolio: pass %zu of %u, best bound %zu\n", best, num_passes,
+                bounds.upper.load());
+    }
+    struct bitvec *cover = passes[best].occ;
+    for (size_t p = 0; p < num_passes; p++) {
+        if (p != best) bitvec_free(passes[p].occ);
+        bitvec_free(passes[p].sub);
     }
 
-    // Start compression
-    size_t i = 0;
-    while (!received_timeout && i < remaining_vertices.size()) {
+    // All vertices that have not been explored are part of the OCT set.
+    const struct pass &pass = passes[best];
+    for (size_t i = pass.last_index_finished + 1; i < pass.order.size(); i++) {
+        bitvec_set(cover, pass.order[i]);
+    }
 
-        // Look up vertex
-        int v = remaining_vertices[i];
+    bitvec_free(sub);
+    return cover;
+}
 
-        // Add v to the subgraph we're looking at
-	    bitvec_set(sub, v);
-	    struct graph *g2 = graph_subgraph(g, sub);
 
-        // If this is already an OCT set, continue on
-        last_index_finished = i;
-	    if (occ_is_occ(g2, occ))
-        {
-            // Make sure to increment loop control and free
-            // subgraph before continuing.
-            i++;
-	        graph_free(g2);
-	        continue;
-	    }
-        else {
-            bitvec_set(occ, v);
-        }
+/* Components are solved one per task, largest first, by THREADS
+   workers taking the next one from a shared counter.  */
+struct component_run {
+    struct component *components;
+    size_t num_components;
+    std::atomic<size_t> next;
+    vector<struct bitvec *> covers;
+    vector<size_t> lower;
+    vector<long> htimes;
+    int seed;
+};
 
-	    struct bitvec *occ_new = occ_shrink(g2, occ, enum2col, use_gray, true, &received_timeout);
+static void solve_components(void *arg, unsigned)
+{
+    struct component_run *run = (struct component_run *) arg;
+    size_t c;
+    while ((c = run->next.fetch_add(1)) < run->num_components) {
+        run->covers[c] = solve(run->components[c].g, run->seed, run->htimes[c],
+                               &run->lower[c]);
+    }
+}
 
-        /* If we cannot compress then occ_new is null and we need to keep occ.
-           Otherwise occ should now point to occ_new */
-        if (occ_new)
-        {
-	        free(occ);
-	        occ = occ_new;
-	        if (!occ_is_occ(g2, occ))
-            {
-		        fprintf(stderr, "Internal error!\n");
-		        abort();
-	        }
-	    }
 
-        // Free the subgraph
-	    graph_free(g2);
+void find_occ(const struct csr *g, int preprocessing, int seed, long htime)
+{
 
-        // Increment i
-        i++;
+    // Determine which optimizations to use
+    if (preprocessing == 1) {
+        run_heuristics = true;
+    }
+    if (preprocessing == 2) {
+        run_heuristics = true;
+        density = true;
+    }
 
+    size_t lower = 0;
+    if (!decompose) {
+        occ = solve(g, seed, htime, &lower);
+    } else {
+        // OCT decomposes over connected components, and bipartite ones
+        // are dropped right away. The heuristics time is shared out by
+        // component size.
+        struct component_run run;
+        run.num_components = csr_components(g, &run.components);
+        run.next = 0;
+        run.covers.resize(run.num_components);
+        run.lower.resize(run.num_components);
+        run.seed = seed;
+        size_t total = 0;
+        for (size_t c = 0; c < run.num_components; c++) {
+            total += csr_size(run.components[c].g);
+        }
+        for (size_t c = 0; c < run.num_components; c++) {
+            long share = htime * (double) csr_size(run.components[c].g) / total;
+            run.htimes.push_back(share > 0 ? share : 1);
+        }
+        if (verbose) {
+            fprintf(stderr, "components: %zu not bipartite, %zu vertices, largest %zu\n",
+                    run.num_components, total,
+                    run.num_components ? csr_size(run.components[0].g) : 0);
+        }
+        unsigned workers = threads < run.num_components ? threads : run.num_components;
+        run_threads(workers > 0 ? workers : 1, solve_components, &run);
+
+        occ = bitvec_make(g->size);
+        for (size_t c = 0; c < run.num_components; c++) {
+            BITVEC_ITER(run.covers[c], v) bitvec_set(occ, run.components[c].original[v]);
+            bitvec_free(run.covers[c]);
+            lower += run.lower[c];
+        }
+        components_free(run.components, run.num_components);
+    }
+
+    // A cover of the kernel becomes one of the input graph.
+    const struct csr *input = g;
+    if (reduction) {
+        struct bitvec *lifted = reduce_lift(reduction, occ);
+        bitvec_free(occ);
+        occ = lifted;
+        input = reduction->g;
+        lower += reduce_count(reduction, REDUCE_SELF_LOOP);
     }
 
     // Print top line of statistics
-    // (n, m, OPT, run time (user), flow augmentations)
+    // (n, m, OPT, run time (user), flow augmentations, lower bound)
     printf(
-        "%5lu %6lu %5lu %10.2f %16llu\n",
-        (unsigned long) g->size,
-        (unsigned long) graph_num_edges(g),
-        (unsigned long) bitvec_count(occ) + remaining_vertices.size() - last_index_finished - 1,
+        "%5lu %6lu %5lu %10.2f %16llu %5lu\n",
+        (unsigned long) csr_size(input),
+        (unsigned long) csr_num_edges(input),
+        (unsigned long) bitvec_count(occ),
         user_time(),
-        augmentations
+        augmentations,
+        (unsigned long) lower
     );
 
     // Print computed OCT set.
-    BITVEC_ITER(occ, v) puts(vertices[v]);
-
-    // Print all vertices that have not been explored. We consider these
-    // as part of the OCT set.
-    for (size_t i = last_index_finished + 1; i < remaining_vertices.size(); i++) {
-         printf("%s\n", vertices[remaining_vertices[i]]);
-    }
-
+    BITVEC_ITER(occ, v) print_vertex(v);
 }
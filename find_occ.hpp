@@ -9,11 +9,20 @@
 #include <vector>
 #include <chrono>
 #include <random>
+#include <atomic>
 
 extern "C" {
     #include "bitvec.h"
+    #include "bound.h"
+    #include "components.h"
+    #include "csr.h"
     #include "graph.h"
     #include "occ.h"
+    #include "perf.h"
+    #include "reduce.h"
+    #include "relabel.h"
+    #include "util.h"
+    #include "workspace.h"
 }
 
 #include "signals.hpp"
@@ -21,15 +30,21 @@ extern "C" {
 #include "heuristics/Graph.hpp"
 
 
-/* Always use enum2col */
+/* Use enum2col unless -g selects the Gray code engine */
 extern bool enum2col;
 extern bool use_gray;
+extern unsigned portfolio;	// number of concurrent compression passes
+extern bool decompose;		// solve connected components separately
+extern unsigned threads;
+extern bool verbose;
 extern struct bitvec *occ;
 extern const char **vertices;
+extern vertex *vertex_map;	// solver vertex -> input vertex, if renumbered
 extern unsigned long long augmentations;
-extern struct graph *g;
+extern struct csr *g;
+extern struct reduction *reduction;	// set if solving on a kernel
 
 double user_time(void);
-void find_occ(const struct graph *g, int preprocessing, int seed, long htime);
+void find_occ(const struct csr *g, int preprocessing, int seed, long htime);
 
 #endif
@@ -17,14 +17,19 @@
    02110-1301, USA.  */
 
 #include <stdlib.h>
+#include <string.h>
 
 #include "bitvec.h"
 #include "flow.h"
 #include "graph.h"
+#include "hbitvec.h"
 #include "util.h"
+#include "workspace.h"
 
 #define NULL_VERTEX ((vertex) -1)
 
+extern bool bidirectional_flow;
+
 struct flow {
     const struct graph *g;
     size_t flow;
@@ -85,9 +90,24 @@ void flow_free(struct flow *flow)
     free(flow);
 }
 
+struct flow *flow_clone(const struct flow *flow)
+{
+    size_t bytes = sizeof (*flow) + flow->g->size * sizeof *flow->flows;
+    struct flow *clone = malloc(bytes);
+    memcpy(clone, flow, bytes);
+    return clone;
+}
+
+void flow_copy(struct flow *dst, const struct flow *src)
+{
+    assert(dst->g->size == src->g->size);
+    dst->flow = src->flow;
+    memcpy(dst->flows, src->flows, src->g->size * sizeof *src->flows);
+}
+
 UNUSED static void verify_flow(const struct flow *flow,
-			       const struct bitvec *sources,
-			       const struct bitvec *targets)
+			       const struct hbitvec *sources,
+			       const struct hbitvec *targets)
 {
     for (size_t i = 0; i < flow->g->size; ++i)
     {
@@ -98,7 +118,7 @@ UNUSED static void verify_flow(const struct flow *flow,
     		    fprintf(stderr, "i = %lu", (unsigned long) i);
             }
     	    assert(flow->flows[flow->flows[i].go_to].come_from == i);
-    	    if (!bitvec_get(sources, i))
+    	    if (!hbitvec_get(sources, i))
             {
     		    assert(flow->flows[i].come_from != NULL_VERTEX);
     		    assert(flow->flows[flow->flows[i].come_from].go_to == i);
@@ -111,7 +131,7 @@ UNUSED static void verify_flow(const struct flow *flow,
 
     	if (flow->flows[i].come_from != NULL_VERTEX) {
     	    assert(flow->flows[flow->flows[i].come_from].go_to == i);
-    	    if (!bitvec_get(targets, i))
+    	    if (!hbitvec_get(targets, i))
             {
     		    assert(flow->flows[i].go_to != NULL_VERTEX);
     		    assert(flow->flows[flow->flows[i].go_to].come_from == i);
@@ -124,22 +144,21 @@ UNUSED static void verify_flow(const struct flow *flow,
     }
 }
 
-bool flow_augment(struct flow *flow, const struct bitvec *sources, const struct bitvec *targets)
+bool flow_augment(struct flow *flow, struct workspace *ws,
+		  const struct hbitvec *sources, const struct hbitvec *targets)
 {
-    size_t size = graph_size(flow->g);
-    vertex predecessors[size * 2];
-    bool seen[size * 2];
-    memset(seen, 0, sizeof seen);
-    vertex queue[size * 2];
-    vertex *qhead = queue, *qtail = queue;
-    BITVEC_ITER(sources, v)
+    assert(ws->capacity >= graph_size(flow->g));
+    workspace_begin(ws);
+    vertex *predecessors = ws->predecessors;
+    vertex *qhead = ws->queue, *qtail = ws->queue;
+    HBITVEC_ITER(sources, v)
     {
 	    if (flow->flows[v].go_to == NULL_VERTEX)
         {
 	        vertex vcode = (v << 1) | OUT;
 	        predecessors[vcode] = v;
 	        *qtail++ = vcode;
-	        seen[vcode] = true;
+	        workspace_mark(ws, ws->visited, vcode);
 	    }
     }
 
@@ -160,26 +179,26 @@ bool flow_augment(struct flow *flow, const struct bitvec *sources, const struct
     		        continue;
                 }
     		    vertex wcode = (w << 1) | IN;
-    		    if (seen[wcode] || w == v_go_to)
+    		    if (workspace_marked(ws, ws->visited, wcode) || w == v_go_to)
                 {
     		        continue;
                 }
 
         		predecessors[wcode] = v;
         		*qtail++ = wcode;
-        		seen[wcode] = true;
+        		workspace_mark(ws, ws->visited, wcode);
 
         		vertex w2code = wcode ^ 1;
-        		if (!seen[w2code] && !flow_vertex_flow(flow, w))
+        		if (!workspace_marked(ws, ws->visited, w2code) && !flow_vertex_flow(flow, w))
                 {
         		    predecessors[w2code] = w;
-        		    if (bitvec_get(targets, w))
+        		    if (hbitvec_get(targets, w))
                     {
         			    target = w;
         			    goto found;
         		    }
         		    *qtail++ = w2code;
-        		    seen[w2code] = true;
+        		    workspace_mark(ws, ws->visited, w2code);
         		}
     	    }
     	}
@@ -189,23 +208,24 @@ bool flow_augment(struct flow *flow, const struct bitvec *sources, const struct
     	    if (w != NULL_VERTEX)
             {
     		    vertex wcode = (w << 1) | OUT;
-    		    if (!seen[wcode])
+    		    if (!workspace_marked(ws, ws->visited, wcode))
                 {
     		        predecessors[wcode] = v;
     		        *qtail++ = wcode;
-    		        seen[wcode] = true;
+    		        workspace_mark(ws, ws->visited, wcode);
 
     		        vertex w2code = wcode ^ 1;
-    		        if (!seen[w2code] && flow_vertex_flow(flow, w))
+    		        if (!workspace_marked(ws, ws->visited, w2code) && flow_vertex_flow(flow, w))
                     {
     			        predecessors[w2code] = w;
     			        *qtail++ = w2code;
-    			        seen[w2code] = true;
+    			        workspace_mark(ws, ws->visited, w2code);
     		        }
     		    }
     	    }
     	}
     }
+    ws->num_reached = qtail - ws->queue;
     return false;
 
     found:;
@@ -231,7 +251,7 @@ bool flow_augment(struct flow *flow, const struct bitvec *sources, const struct
     		    flow->flows[s].go_to = t;
     	    }
     	}
-    	if (bitvec_get(sources, s) && s_port == IN)
+    	if (hbitvec_get(sources, s) && s_port == IN)
         {
     	    flow->flow++;
     	    break;
@@ -243,19 +263,27 @@ bool flow_augment(struct flow *flow, const struct bitvec *sources, const struct
     return true;
 }
 
-bool flow_augment_pair(struct flow *flow, vertex source, vertex target)
+static void apply_path(struct flow *flow, const vertex *predecessors,
+		       vertex source, vertex target);
+static bool augment_pair_bidirectional(struct flow *flow, struct workspace *ws,
+				       vertex source, vertex target);
+
+bool flow_augment_pair(struct flow *flow, struct workspace *ws,
+		       vertex source, vertex target)
 {
-    size_t size = graph_size(flow->g);
-    vertex predecessors[size * 2];
-    bool seen[size * 2];
-    memset(seen, 0, sizeof seen);
-    vertex queue[size * 2];
-    vertex *qhead = queue, *qtail = queue;
+    if (bidirectional_flow)
+    {
+        return augment_pair_bidirectional(flow, ws, source, target);
+    }
+    assert(ws->capacity >= graph_size(flow->g));
+    workspace_begin(ws);
+    vertex *predecessors = ws->predecessors;
+    vertex *qhead = ws->queue, *qtail = ws->queue;
     //assert(flow->flows[source].go_to == NULL_VERTEX);
     vertex sourcecode = (source << 1) | OUT;
     predecessors[sourcecode] = source;
     *qtail++ = sourcecode;
-    seen[sourcecode] = true;
+    workspace_mark(ws, ws->visited, sourcecode);
 
     while (qhead != qtail)
     {
@@ -272,23 +300,23 @@ bool flow_augment_pair(struct flow *flow, vertex source, vertex target)
         		    continue;
                 }
         		vertex wcode = (w << 1) | IN;
-        		if (seen[wcode] || w == flow->flows[v].go_to)
+        		if (workspace_marked(ws, ws->visited, wcode) || w == flow->flows[v].go_to)
                 {
         		    continue;
                 }
 
         		predecessors[wcode] = v;
         		*qtail++ = wcode;
-        		seen[wcode] = true;
+        		workspace_mark(ws, ws->visited, wcode);
 
         		vertex w2code = wcode ^ 1;
-        		if (!seen[w2code] && !flow_vertex_flow(flow, w))
+        		if (!workspace_marked(ws, ws->visited, w2code) && !flow_vertex_flow(flow, w))
                 {
         		    predecessors[w2code] = w;
         		    if (w == target)
         			goto found;
         		    *qtail++ = w2code;
-        		    seen[w2code] = true;
+        		    workspace_mark(ws, ws->visited, w2code);
         		}
     	    }
     	}
@@ -299,26 +327,36 @@ bool flow_augment_pair(struct flow *flow, vertex source, vertex target)
             {
     		    assert(graph_vertex_exists(flow->g, w));
     		    vertex wcode = (w << 1) | OUT;
-    		    if (!seen[wcode])
+    		    if (!workspace_marked(ws, ws->visited, wcode))
                 {
     		        predecessors[wcode] = v;
         		    *qtail++ = wcode;
-        		    seen[wcode] = true;
+        		    workspace_mark(ws, ws->visited, wcode);
 
         		    vertex w2code = wcode ^ 1;
-        		    if (!seen[w2code] && flow_vertex_flow(flow, w))
+        		    if (!workspace_marked(ws, ws->visited, w2code) && flow_vertex_flow(flow, w))
                     {
             			predecessors[w2code] = w;
             			*qtail++ = w2code;
-            			seen[w2code] = true;
+            			workspace_mark(ws, ws->visited, w2code);
         		    }
     		    }
     	    }
 	    }
     }
+    ws->num_reached = qtail - ws->queue;
     return false;
 
-    found:;
+    found:
+    apply_path(flow, predecessors, source, target);
+    return true;
+}
+
+/* Flip the flow along the path recorded in PREDECESSORS, which leads
+   from the out port of SOURCE to the out port of TARGET.  */
+static void apply_path(struct flow *flow, const vertex *predecessors,
+		       vertex source, vertex target)
+{
     port_t t_port = OUT;
     vertex t = target;
     while (1)
@@ -352,6 +390,344 @@ bool flow_augment_pair(struct flow *flow, vertex source, vertex target)
     	t = s;
     	t_port = s_port;
     }
+}
+
+/* Record that the search owning SEEN reached CODE from vertex FROM
+   (whose port is the opposite of CODE's) and queue it. Returns true if
+   CODE is new and the search owning OTHER_SEEN has already reached
+   it, which closes an augmenting path.  */
+static inline bool visit(const struct workspace *ws, unsigned *seen,
+			 const unsigned *other_seen, vertex *links,
+			 vertex **qtail, vertex code, vertex from)
+{
+    if (workspace_marked(ws, seen, code))
+    {
+        return false;
+    }
+    workspace_mark(ws, seen, code);
+    links[code] = from;
+    *(*qtail)++ = code;
+    return workspace_marked(ws, other_seen, code);
+}
+
+/* Expand one BFS level of the search from the source over residual
+   arcs. Returns true and sets *MEET when it touches the other search.  */
+static bool forward_level(const struct flow *flow, struct workspace *ws,
+			  vertex **qhead, vertex **qtail, vertex *meet)
+{
+    vertex *end = *qtail;
+    while (*qhead != end)
+    {
+        vertex vcode = *(*qhead)++;
+        vertex v = vcode >> 1, w;
+        vertex next[2] = { NULL_VERTEX, NULL_VERTEX };
+        size_t num_next = 0;
+        if ((vcode & 1) == OUT)
+        {
+            // Unused edges, and back into v if v carries flow.
+            GRAPH_NEIGHBORS_ITER(flow->g, v, w)
+            {
+                if (!graph_vertex_exists(flow->g, w) || w == flow->flows[v].go_to)
+                {
+                    continue;
+                }
+                if (visit(ws, ws->visited, ws->back_visited, ws->predecessors,
+                          qtail, (w << 1) | IN, v))
+                {
+                    *meet = (w << 1) | IN;
+                    return true;
+                }
+            }
+            if (flow_vertex_flow(flow, v))
+            {
+                next[num_next++] = vcode ^ 1;
+            }
+        }
+        else if (!flow_vertex_flow(flow, v))
+        {
+            next[num_next++] = vcode ^ 1;
+        }
+        else if (flow->flows[v].come_from != NULL_VERTEX)
+        {
+            // Cancel the flow arriving at v.
+            next[num_next++] = (flow->flows[v].come_from << 1) | OUT;
+        }
+        for (size_t i = 0; i < num_next; ++i)
+        {
+            if (visit(ws, ws->visited, ws->back_visited, ws->predecessors,
+                      qtail, next[i], v))
+            {
+                *meet = next[i];
+                return true;
+            }
+        }
+    }
+    return false;
+}
+
+/* Like forward_level, but searching from the target over reversed
+   residual arcs.  */
+static bool backward_level(const struct flow *flow, struct workspace *ws,
+			   vertex **qhead, vertex **qtail, vertex *meet)
+{
+    vertex *end = *qtail;
+    while (*qhead != end)
+    {
+        vertex wcode = *(*qhead)++;
+        vertex w = wcode >> 1, v;
+        vertex prev[2] = { NULL_VERTEX, NULL_VERTEX };
+        size_t num_prev = 0;
+        if ((wcode & 1) == IN)
+        {
+            // Unused edges, and from the out port if w carries flow.
+            GRAPH_NEIGHBORS_ITER(flow->g, w, v)
+            {
+                if (!graph_vertex_exists(flow->g, v) || flow->flows[v].go_to == w)
+                {
+                    continue;
+                }
+                if (visit(ws, ws->back_visited, ws->visited, ws->successors,
+                          qtail, (v << 1) | OUT, w))
+                {
+                    *meet = (v << 1) | OUT;
+                    return true;
+                }
+            }
+            if (flow_vertex_flow(flow, w))
+            {
+                prev[num_prev++] = wcode ^ 1;
+            }
+        }
+        else if (!flow_vertex_flow(flow, w))
+        {
+            prev[num_prev++] = wcode ^ 1;
+        }
+        else if (flow->flows[w].go_to != NULL_VERTEX)
+        {
+            // Reached by cancelling the flow leaving w.
+            prev[num_prev++] = (flow->flows[w].go_to << 1) | IN;
+        }
+        for (size_t i = 0; i < num_prev; ++i)
+        {
+            if (visit(ws, ws->back_visited, ws->visited, ws->successors,
+                      qtail, prev[i], w))
+            {
+                *meet = prev[i];
+                return true;
+            }
+        }
+    }
+    return false;
+}
+
+/* Same as the search in flow_augment_pair, but growing a second BFS
+   tree backwards from the target and always expanding the smaller
+   frontier by one level, so both trees stay shallow on graphs of large
+   diameter. Once they touch, the backward half of the path is copied
+   into the predecessors and the flow is updated as usual.  */
+/* Number of arcs leaving VCODE in the residual network: out ports have
+   one per neighbor and one back to their in port, in ports just one.  */
+static inline size_t num_arcs(const struct flow *flow, vertex vcode)
+{
+    return (vcode & 1) == OUT ? flow->g->vertices[vcode >> 1]->deg + 1 : 1;
+}
+
+/* Head of arc I leaving VCODE, or NULL_VERTEX if it is saturated. The
+   arc of an in port goes to the out port if the vertex is unused and
+   against the flow arriving at it otherwise; the extra arc of an out
+   port goes back to the in port if the vertex is used.  */
+static inline vertex residual_arc(const struct flow *flow, vertex vcode, size_t i)
+{
+    vertex v = vcode >> 1;
+    if ((vcode & 1) == OUT)
+    {
+        const struct vertex *pv = flow->g->vertices[v];
+        if (i < pv->deg)
+        {
+            vertex w = pv->neighbors[i];
+            return graph_vertex_exists(flow->g, w) && w != flow->flows[v].go_to
+                ? (w << 1) | IN : NULL_VERTEX;
+        }
+        return flow_vertex_flow(flow, v) ? vcode ^ 1 : NULL_VERTEX;
+    }
+    if (!flow_vertex_flow(flow, v))
+    {
+        return vcode ^ 1;
+    }
+    if (flow->flows[v].come_from != NULL_VERTEX)
+    {
+        return (flow->flows[v].come_from << 1) | OUT;
+    }
+    return NULL_VERTEX;
+}
+
+/* An augmenting path may end at the out port of an unused target.  */
+static inline bool is_sink(const struct flow *flow, const struct hbitvec *targets,
+			   vertex vcode)
+{
+    return (vcode & 1) == OUT && hbitvec_get(targets, vcode >> 1)
+        && !flow_vertex_flow(flow, vcode >> 1);
+}
+
+size_t flow_augment_blocking(struct flow *flow, struct workspace *ws,
+			     const struct hbitvec *sources,
+			     const struct hbitvec *targets)
+{
+    assert(ws->capacity >= graph_size(flow->g));
+    workspace_begin(ws);
+    vertex *levels = ws->levels, *arcs = ws->arcs;
+
+    // Level graph: BFS from all unused sources, stopping at the level
+    // of the nearest sink, since only shortest paths are wanted.
+    vertex *qhead = ws->queue, *qtail = ws->queue;
+    HBITVEC_ITER(sources, v)
+    {
+        if (flow->flows[v].go_to == NULL_VERTEX)
+        {
+            vertex vcode = (v << 1) | OUT;
+            workspace_mark(ws, ws->visited, vcode);
+            levels[vcode] = 0;
+            arcs[vcode] = 0;
+            *qtail++ = vcode;
+        }
+    }
+    vertex sink_level = NULL_VERTEX;
+    while (qhead != qtail)
+    {
+        vertex vcode = *qhead++;
+        if (levels[vcode] >= sink_level)
+        {
+            break;
+        }
+        for (size_t i = 0, n = num_arcs(flow, vcode); i < n; ++i)
+        {
+            vertex wcode = residual_arc(flow, vcode, i);
+            if (wcode == NULL_VERTEX || workspace_marked(ws, ws->visited, wcode))
+            {
+                continue;
+            }
+            workspace_mark(ws, ws->visited, wcode);
+            levels[wcode] = levels[vcode] + 1;
+            arcs[wcode] = 0;
+            if (is_sink(flow, targets, wcode))
+            {
+                sink_level = levels[wcode];
+            }
+            else
+            {
+                *qtail++ = wcode;
+            }
+        }
+    }
+    if (sink_level == NULL_VERTEX)
+    {
+        ws->num_reached = qtail - ws->queue;
+        return 0;
+    }
+
+    // Blocking flow: a DFS per source along level-increasing residual
+    // arcs. ARCS holds the next arc to try, so every arc is rejected at
+    // most once per phase; dead ends get their level invalidated.
+    size_t paths = 0;
+    vertex *stack = ws->back_queue;
+    HBITVEC_ITER(sources, s)
+    {
+        vertex scode = (s << 1) | OUT;
+        if (flow->flows[s].go_to != NULL_VERTEX
+            || !workspace_marked(ws, ws->visited, scode) || levels[scode] != 0)
+        {
+            continue;
+        }
+        size_t depth = 0;
+        stack[depth++] = scode;
+        while (depth > 0)
+        {
+            vertex vcode = stack[depth - 1];
+            if (levels[vcode] == sink_level)
+            {
+                if (is_sink(flow, targets, vcode))
+                {
+                    ws->predecessors[scode] = s;
+                    for (size_t i = 1; i < depth; ++i)
+                    {
+                        ws->predecessors[stack[i]] = stack[i - 1] >> 1;
+                    }
+                    apply_path(flow, ws->predecessors, s, vcode >> 1);
+                    paths++;
+                    break;
+                }
+                levels[vcode] = NULL_VERTEX;
+                depth--;
+                continue;
+            }
+            vertex wcode = NULL_VERTEX;
+            for (size_t n = num_arcs(flow, vcode); arcs[vcode] < n; arcs[vcode]++)
+            {
+                wcode = residual_arc(flow, vcode, arcs[vcode]);
+                if (wcode != NULL_VERTEX && workspace_marked(ws, ws->visited, wcode)
+                    && levels[wcode] == levels[vcode] + 1)
+                {
+                    break;
+                }
+                wcode = NULL_VERTEX;
+            }
+            if (wcode != NULL_VERTEX)
+            {
+                stack[depth++] = wcode;
+            }
+            else
+            {
+                levels[vcode] = NULL_VERTEX;
+                depth--;
+            }
+        }
+    }
+    assert(paths > 0);
+    return paths;
+}
+
+static bool augment_pair_bidirectional(struct flow *flow, struct workspace *ws,
+				       vertex source, vertex target)
+{
+    assert(ws->capacity >= graph_size(flow->g));
+    workspace_begin(ws);
+    vertex *fhead = ws->queue, *ftail = ws->queue;
+    vertex *bhead = ws->back_queue, *btail = ws->back_queue;
+    vertex sourcecode = (source << 1) | OUT, targetcode = (target << 1) | IN;
+    visit(ws, ws->visited, ws->back_visited, ws->predecessors, &ftail, sourcecode, source);
+    // The path has to end with the in-out arc of an unused target.
+    if (!flow_vertex_flow(flow, target))
+    {
+        visit(ws, ws->back_visited, ws->visited, ws->successors, &btail, targetcode, target);
+    }
+    vertex meet;
+    while (fhead != ftail && bhead != btail)
+    {
+        if (ftail - fhead <= btail - bhead
+            ? forward_level(flow, ws, &fhead, &ftail, &meet)
+            : backward_level(flow, ws, &bhead, &btail, &meet))
+        {
+            goto found;
+        }
+    }
+    // Either tree being complete proves there is no path. Complete the
+    // forward one as well, since flow_last_cut reads it.
+    while (fhead != ftail)
+    {
+        forward_level(flow, ws, &fhead, &ftail, &meet);
+    }
+    ws->num_reached = ftail - ws->queue;
+    return false;
+
+    found:;
+    vertex targetout = targetcode ^ 1;
+    for (vertex code = meet; code != targetout; )
+    {
+        vertex next = (ws->successors[code] << 1) | ((code & 1) ^ 1);
+        ws->predecessors[next] = code >> 1;
+        code = next;
+    }
+    apply_path(flow, ws->predecessors, source, target);
     return true;
 }
 
@@ -385,25 +761,23 @@ vertex flow_drain_target(struct flow *flow, vertex target)
     return v;
 }
 
-struct bitvec *flow_vertex_cut(const struct flow *flow, const struct bitvec *sources)
+struct hbitvec *flow_vertex_cut(const struct flow *flow, struct workspace *ws,
+				const struct hbitvec *sources)
 {
     size_t size = graph_size(flow->g);
-    assert(bitvec_size(sources) >= size);
-    ALLOCA_BITVEC(enqueued, size * 2);
-    ALLOCA_BITVEC(seen, size);
-    ALLOCA_BITVEC(reached, size);
-    vertex queue[size * 2];
-    vertex *qhead = queue, *qtail = queue;
-
-    for (size_t v = bitvec_find(sources, 0); v != BITVEC_NOT_FOUND; v = bitvec_find(sources, v + 1))
+    assert(hbitvec_size(sources) >= size && ws->capacity >= size);
+    workspace_begin(ws);
+    vertex *qhead = ws->queue, *qtail = ws->queue;
+
+    HBITVEC_ITER(sources, v)
     {
-	    bitvec_set(seen, v);
+	    workspace_mark(ws, ws->seen, v);
 	    if (!flow_vertex_flow(flow, v))
         {
     	    vertex vcode = (v << 1) | OUT;
     	    *qtail++ = vcode;
-    	    bitvec_set(enqueued, vcode);
-    	    bitvec_set(reached, v);
+    	    workspace_mark(ws, ws->visited, vcode);
+    	    workspace_mark(ws, ws->reached, v);
 	    }
     }
 
@@ -422,39 +796,70 @@ struct bitvec *flow_vertex_cut(const struct flow *flow, const struct bitvec *sou
 
     	    port_t wport = port ^ 1;
     	    vertex wcode = (w << 1) | wport;
-    	    if (bitvec_get(enqueued, wcode))
+    	    if (workspace_marked(ws, ws->visited, wcode))
             {
     		    continue;
             }
 
             if (port == OUT) {
-    		    bitvec_set(seen, w);
+    		    workspace_mark(ws, ws->seen, w);
             }
 
     	    if (port == OUT ? w != flow->flows[v].go_to : w == flow->flows[v].come_from)
             {
         		*qtail++ = wcode;
-        		bitvec_set(enqueued, wcode);
+        		workspace_mark(ws, ws->visited, wcode);
         		if (wport == OUT)
                 {
-        		    bitvec_set(reached, w);
+        		    workspace_mark(ws, ws->reached, w);
                 }
 
         		vertex w2code = wcode ^ 1;
-        		if (!bitvec_get(enqueued, w2code) && flow_vertex_flow(flow, w) == (port == IN))
+        		if (!workspace_marked(ws, ws->visited, w2code) && flow_vertex_flow(flow, w) == (port == IN))
                 {
         		    *qtail++ = w2code;
-        		    bitvec_set(enqueued, w2code);
+        		    workspace_mark(ws, ws->visited, w2code);
         		    if (port == OUT)
-        			bitvec_set(reached, w);
+        			workspace_mark(ws, ws->reached, w);
     		    }
     	    }
     	}
     }
 
-    struct bitvec *cut = bitvec_make(size);
-    bitvec_copy(cut, seen);
-    bitvec_setminus(cut, reached);
+    // The cut is small, so collect it sparsely.
+    struct hbitvec *cut = hbitvec_make(size);
+    for (size_t v = 0; v < size; ++v)
+    {
+        if (workspace_marked(ws, ws->seen, v) && !workspace_marked(ws, ws->reached, v))
+        {
+            hbitvec_set(cut, v);
+        }
+    }
+    return cut;
+}
+
+struct hbitvec *flow_last_cut(const struct flow *flow, const struct workspace *ws,
+			      const struct hbitvec *sources)
+{
+    // The vertices whose in port was reached but not their out port,
+    // plus the saturated sources whose out port was not reached; the
+    // same as flow_vertex_cut computes.
+    struct hbitvec *cut = hbitvec_make(graph_size(flow->g));
+    for (size_t i = 0; i < ws->num_reached; ++i)
+    {
+        vertex vcode = ws->queue[i];
+        if ((vcode & 1) == IN && !workspace_marked(ws, ws->visited, vcode ^ 1))
+        {
+            hbitvec_set(cut, vcode >> 1);
+        }
+    }
+    HBITVEC_ITER(sources, v)
+    {
+        if (!workspace_marked(ws, ws->visited, (v << 1) | OUT))
+        {
+            hbitvec_set(cut, v);
+        }
+    }
     return cut;
 }
 
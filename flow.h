@@ -24,23 +24,44 @@
 #include "graph.h"
 
 struct flow;
+struct hbitvec;
+struct workspace;
 
 struct flow* flow_make(const struct graph *g);
 void flow_clear(struct flow *flow);
 void flow_free(struct flow *flow);
+/* A copy of FLOW on the same graph.  */
+struct flow *flow_clone(const struct flow *flow);
+/* Overwrite the paths in DST with those in SRC, which must be a flow on
+   a graph of the same size (usually a copy of the graph of DST).  */
+void flow_copy(struct flow *dst, const struct flow *src);
 
 size_t flow_flow(const struct flow *flow);
 bool flow_vertex_flow(const struct flow *flow, vertex v);
 bool flow_is_source(const struct flow *flow, vertex v);
 bool flow_is_target(const struct flow *flow, vertex v);
 
-bool flow_augment(struct flow *flow, const struct bitvec *sources,
-		  const struct bitvec *targets);
-bool flow_augment_pair(struct flow *flow, vertex source, vertex target);
+/* The searches below take their scratch memory from WS, which must be
+   reserved for at least as many vertices as the flow graph has.  */
+bool flow_augment(struct flow *flow, struct workspace *ws,
+		  const struct hbitvec *sources, const struct hbitvec *targets);
+bool flow_augment_pair(struct flow *flow, struct workspace *ws,
+		       vertex source, vertex target);
+/* One Dinic phase: augment along a maximal set of vertex-disjoint
+   shortest paths. Returns their number, 0 if there is none.  */
+size_t flow_augment_blocking(struct flow *flow, struct workspace *ws,
+			     const struct hbitvec *sources,
+			     const struct hbitvec *targets);
 vertex flow_drain_source(struct flow *flow, vertex source);
 vertex flow_drain_target(struct flow *flow, vertex target);
-struct bitvec *flow_vertex_cut(const struct flow *flow,
-			       const struct bitvec *sources);
+struct hbitvec *flow_vertex_cut(const struct flow *flow, struct workspace *ws,
+				const struct hbitvec *sources);
+/* The cut flow_vertex_cut would return, read off the search state that
+   the last failed augmentation left in WS, without another search. WS
+   must not have been used since, and SOURCES must be those the failed
+   search started from: the unused ones among them were its starts.  */
+struct hbitvec *flow_last_cut(const struct flow *flow, const struct workspace *ws,
+			      const struct hbitvec *sources);
 void flow_dump(const struct flow *flow);
 
 #endif
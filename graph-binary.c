@@ -0,0 +1,214 @@
+/* occ -- find minimum odd cycle covers (Graph Bipartization)
+   Copyright (C) 2006 Falk Hueffner
+
+   This program is free software; you can redistribute it and/or
+   modify it under the terms of the GNU General Public License as
+   published by the Free Software Foundation; either version 2 of
+   the License, or (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with GCC; see the file COPYING.  If not, write to the Free
+   Software Foundation, 51 Franklin Street, Fifth Floor, Boston, MA
+   02110-1301, USA.  */
+
+/* Binary graph format. All fields are in native byte order; a file
+   written on a machine with a different byte order is rejected.
+
+     header        struct occb_header (48 bytes)
+     offsets       size + 1 uint64_t
+     neighbors     num_arcs entries of vertex_bytes each, padded to 8
+     name offsets  size uint64_t          (only with OCCB_NAMES)
+     name pool     names_bytes bytes of NUL-terminated names
+
+   With matching word sizes, offsets and neighbors are used directly
+   from the mapped file.  */
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+
+#include "csr.h"
+#include "graph.h"
+
+#define OCCB_VERSION 1
+#define OCCB_BYTE_ORDER 0x01020304
+#define OCCB_NAMES 1
+
+struct occb_header {
+    char magic[4];
+    uint32_t version;
+    uint32_t byte_order;
+    uint32_t vertex_bytes;
+    uint32_t flags;
+    uint32_t reserved;
+    uint64_t size;
+    uint64_t num_arcs;
+    uint64_t names_bytes;
+};
+
+static const char occb_magic[4] = { 'O', 'C', 'C', 'B' };
+
+static inline uint64_t pad8(uint64_t n)
+{
+    return (n + 7) & ~(uint64_t) 7;
+}
+
+bool graph_is_binary(const void *data, size_t len)
+{
+    return len >= sizeof occb_magic && memcmp(data, occb_magic, sizeof occb_magic) == 0;
+}
+
+bool graph_write_binary(const struct csr *g, const char **names, FILE *stream)
+{
+    struct occb_header header = {
+        .version      = OCCB_VERSION,
+        .byte_order   = OCCB_BYTE_ORDER,
+        .vertex_bytes = sizeof (vertex),
+        .flags        = names ? OCCB_NAMES : 0,
+        .size         = csr_size(g),
+        .num_arcs     = g->offsets[csr_size(g)],
+    };
+    memcpy(header.magic, occb_magic, sizeof occb_magic);
+    if (names)
+    {
+        for (size_t v = 0; v < csr_size(g); ++v)
+        {
+            header.names_bytes += strlen(names[v]) + 1;
+        }
+    }
+    fwrite(&header, sizeof header, 1, stream);
+
+    for (size_t v = 0; v <= csr_size(g); ++v)
+    {
+        uint64_t offset = g->offsets[v];
+        fwrite(&offset, sizeof offset, 1, stream);
+    }
+
+    size_t neighbor_bytes = header.num_arcs * sizeof (vertex);
+    fwrite(g->neighbors, 1, neighbor_bytes, stream);
+    static const char zeros[8];
+    fwrite(zeros, 1, pad8(neighbor_bytes) - neighbor_bytes, stream);
+
+    if (names)
+    {
+        uint64_t offset = 0;
+        for (size_t v = 0; v < csr_size(g); ++v)
+        {
+            fwrite(&offset, sizeof offset, 1, stream);
+            offset += strlen(names[v]) + 1;
+        }
+        for (size_t v = 0; v < csr_size(g); ++v)
+        {
+            fwrite(names[v], 1, strlen(names[v]) + 1, stream);
+        }
+    }
+
+    return !ferror(stream);
+}
+
+static uint64_t read_uint(const unsigned char *p, size_t bytes)
+{
+    switch (bytes)
+    {
+    case 2: { uint16_t x; memcpy(&x, p, sizeof x); return x; }
+    case 4: { uint32_t x; memcpy(&x, p, sizeof x); return x; }
+    default: { uint64_t x; memcpy(&x, p, sizeof x); return x; }
+    }
+}
+
+struct csr *graph_map_binary(void *map, size_t len, const char ***vertex_names)
+{
+    const struct occb_header *header = map;
+    const unsigned char *base = map;
+    if (len < sizeof *header || !graph_is_binary(map, len)
+        || header->version != OCCB_VERSION
+        || header->byte_order != OCCB_BYTE_ORDER
+        || (header->vertex_bytes != 2 && header->vertex_bytes != 4
+            && header->vertex_bytes != 8))
+    {
+        fprintf(stderr, "unsupported binary graph format\n");
+        exit(1);
+    }
+
+    uint64_t size = header->size, num_arcs = header->num_arcs;
+    uint64_t offsets_pos = sizeof *header;
+    uint64_t neighbors_pos = offsets_pos + (size + 1) * sizeof (uint64_t);
+    uint64_t names_pos = neighbors_pos + pad8(num_arcs * header->vertex_bytes);
+    uint64_t end = names_pos;
+    if (header->flags & OCCB_NAMES)
+    {
+        end += size * sizeof (uint64_t) + header->names_bytes;
+    }
+    if (end > len)
+    {
+        fprintf(stderr, "truncated binary graph\n");
+        exit(1);
+    }
+    if (size > VERTEX_MAX)
+    {
+        fprintf(stderr, "Graph has more than %zu vertices; "
+                "rebuild with a larger OCC_VERTEX_BITS\n", VERTEX_MAX);
+        exit(1);
+    }
+
+    struct csr *g = malloc(sizeof *g);
+    g->size = size;
+    if (sizeof (size_t) == sizeof (uint64_t) && header->vertex_bytes == sizeof (vertex))
+    {
+        // Nothing to convert: use the file contents as they are.
+        g->offsets = (size_t *) (base + offsets_pos);
+        g->neighbors = (vertex *) (base + neighbors_pos);
+        g->map = map;
+        g->map_size = len;
+    }
+    else
+    {
+        g->offsets = malloc((size + 1) * sizeof *g->offsets);
+        g->neighbors = malloc((num_arcs ? num_arcs : 1) * sizeof *g->neighbors);
+        g->map = NULL;
+        g->map_size = 0;
+        for (size_t v = 0; v <= size; ++v)
+        {
+            g->offsets[v] = read_uint(base + offsets_pos + v * sizeof (uint64_t),
+                                      sizeof (uint64_t));
+        }
+        for (size_t i = 0; i < num_arcs; ++i)
+        {
+            uint64_t w = read_uint(base + neighbors_pos + i * header->vertex_bytes,
+                                   header->vertex_bytes);
+            if (w >= size)
+            {
+                fprintf(stderr, "corrupt binary graph\n");
+                exit(1);
+            }
+            g->neighbors[i] = w;
+        }
+    }
+    if (g->offsets[size] != num_arcs)
+    {
+        fprintf(stderr, "corrupt binary graph\n");
+        exit(1);
+    }
+
+    // Names stay in the mapping, so it must outlive them.
+    *vertex_names = NULL;
+    if (header->flags & OCCB_NAMES)
+    {
+        const char **names = malloc((size ? size : 1) * sizeof *names);
+        const char *pool = (const char *) base + names_pos + size * sizeof (uint64_t);
+        for (size_t v = 0; v < size; ++v)
+        {
+            names[v] = pool + read_uint(base + names_pos + v * sizeof (uint64_t),
+                                        sizeof (uint64_t));
+        }
+        *vertex_names = names;
+    }
+
+    return g;
+}
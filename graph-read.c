@@ -0,0 +1,542 @@
+/* occ -- find minimum odd cycle covers (Graph Bipartization)
+   Copyright (C) 2006 Falk Hueffner
+
+   This program is free software; you can redistribute it and/or
+   modify it under the terms of the GNU General Public License as
+   published by the Free Software Foundation; either version 2 of
+   the License, or (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with GCC; see the file COPYING.  If not, write to the Free
+   Software Foundation, 51 Franklin Street, Fifth Floor, Boston, MA
+   02110-1301, USA.  */
+
+#define _POSIX_C_SOURCE 200112L
+
+#include <fcntl.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "csr.h"
+#include "graph.h"
+#include "names.h"
+#include "util.h"
+
+extern unsigned threads;
+extern bool deterministic;
+extern bool integer_ids;
+
+#define NULL_VERTEX ((vertex) -1)
+
+static inline bool is_space(char c)
+{
+    return c == ' ' || c == '\f' || c == '\r' || c == '\t' || c == '\v';
+}
+
+static inline const char *line_end(const char *p, const char *end)
+{
+    const char *eol = memchr(p, '\n', end - p);
+    return eol ? eol : end;
+}
+
+static inline const char *next_line(const char *eol, const char *end)
+{
+    return eol < end ? eol + 1 : end;
+}
+
+static bool has_prefix(const char *p, const char *eol, const char *prefix)
+{
+    size_t len = strlen(prefix);
+    return (size_t) (eol - p) >= len && memcmp(p, prefix, len) == 0;
+}
+
+/* Return the next whitespace-separated token before EOL and advance
+   *P past it, or return NULL if the rest of the line is blank.  */
+static const char *next_token(const char **p, const char *eol, size_t *len)
+{
+    const char *s = *p;
+    while (s < eol && is_space(*s))
+    {
+        ++s;
+    }
+    if (s == eol)
+    {
+        *p = s;
+        return NULL;
+    }
+
+    const char *t = s;
+    while (t < eol && !is_space(*t))
+    {
+        ++t;
+    }
+    *p = t;
+    *len = t - s;
+    return s;
+}
+
+struct edge_list
+{
+    size_t count, capacity;
+    vertex (*edges)[2];
+};
+
+static void edge_list_init(struct edge_list *list)
+{
+    list->count = 0;
+    list->capacity = 64;
+    list->edges = malloc(list->capacity * sizeof *list->edges);
+}
+
+static inline void edge_list_push(struct edge_list *list, vertex v, vertex w)
+{
+    if (list->count >= list->capacity)
+    {
+        list->capacity *= 2;
+        list->edges = realloc(list->edges, list->capacity * sizeof *list->edges);
+    }
+    list->edges[list->count][0] = v;
+    list->edges[list->count][1] = w;
+    list->count++;
+}
+
+/* If [P, END) starts with the header of Sebastian's graph format,
+   return the start of the line following "# Edges", else P.  */
+static const char *skip_header(const char *p, const char *end, size_t *line_num)
+{
+    const char *eol = line_end(p, end);
+    if (!has_prefix(p, eol, "# Graph Name"))
+    {
+        return p;
+    }
+
+    do
+    {
+        p = next_line(eol, end);
+        eol = line_end(p, end);
+        ++*line_num;
+    } while (p < end && !has_prefix(p, eol, "# Edges"));
+    ++*line_num;
+    return next_line(eol, end);
+}
+
+/* Parse the edge list in [P, END), whose first line is line LINE_NUM
+   + 1 of the file, in place. Tokens are interned straight from the
+   buffer, so the only copy of a name is the one in the string pool.  */
+static void parse_range(const char *p, const char *end, size_t line_num,
+			struct names *names, struct edge_list *edges)
+{
+    while (p < end)
+    {
+        p = skip_header(p, end, &line_num);
+        if (p == end)
+        {
+            break;
+        }
+        const char *eol = line_end(p, end);
+        ++line_num;
+
+        const char *q = p, *name[2];
+        size_t len[2];
+        name[0] = next_token(&q, eol, &len[0]);
+        if (!name[0] || name[0][0] == '#')
+        {
+            p = next_line(eol, end);
+            continue;
+        }
+        name[1] = next_token(&q, eol, &len[1]);
+        if (!name[1] || name[1][0] == '#')
+        {
+            fprintf(stderr, "Syntax error on line %zu\n", line_num);
+            exit(1);
+        }
+        size_t rest_len;
+        const char *rest = next_token(&q, eol, &rest_len);
+        if (rest && rest[0] != '#')
+        {
+            fprintf(stderr, "warning: ignoring trailing garbage on line %zu\n",
+                    line_num);
+        }
+
+        edge_list_push(edges, names_intern(names, name[0], len[0]),
+                       names_intern(names, name[1], len[1]));
+        p = next_line(eol, end);
+    }
+}
+
+/* Parse a vertex number. Anything but a plain decimal number fails,
+   including numbers with leading zeros, which as names would be
+   different from the same number without them.  */
+static bool parse_vertex(const char *s, size_t len, vertex *v)
+{
+    if (len == 0 || (len > 1 && s[0] == '0'))
+    {
+        return false;
+    }
+
+    size_t x = 0;
+    for (size_t i = 0; i < len; ++i)
+    {
+        unsigned digit = (unsigned char) s[i] - '0';
+        if (digit > 9 || x > (VERTEX_MAX - 1 - digit) / 10)
+        {
+            return false;
+        }
+        x = x * 10 + digit;
+    }
+    *v = x;
+    return true;
+}
+
+/* Like parse_range, but for graphs whose vertex names are numbers,
+   which are used as vertices directly. Returns false at the first
+   token that is not a number.  */
+static bool parse_range_integers(const char *p, const char *end, size_t line_num,
+				 struct edge_list *edges, vertex *max_vertex)
+{
+    while (p < end)
+    {
+        p = skip_header(p, end, &line_num);
+        if (p == end)
+        {
+            break;
+        }
+        const char *eol = line_end(p, end);
+        ++line_num;
+
+        const char *q = p, *name[2];
+        size_t len[2];
+        name[0] = next_token(&q, eol, &len[0]);
+        if (!name[0] || name[0][0] == '#')
+        {
+            p = next_line(eol, end);
+            continue;
+        }
+        name[1] = next_token(&q, eol, &len[1]);
+        if (!name[1] || name[1][0] == '#')
+        {
+            fprintf(stderr, "Syntax error on line %zu\n", line_num);
+            exit(1);
+        }
+        size_t rest_len;
+        const char *rest = next_token(&q, eol, &rest_len);
+        if (rest && rest[0] != '#')
+        {
+            fprintf(stderr, "warning: ignoring trailing garbage on line %zu\n",
+                    line_num);
+        }
+
+        vertex v, w;
+        if (!parse_vertex(name[0], len[0], &v) || !parse_vertex(name[1], len[1], &w))
+        {
+            if (integer_ids)
+            {
+                fprintf(stderr, "Vertex is not a number below %zu on line %zu\n",
+                        VERTEX_MAX, line_num);
+                exit(1);
+            }
+            return false;
+        }
+        edge_list_push(edges, v, w);
+        if (v > *max_vertex || *max_vertex == NULL_VERTEX)
+        {
+            *max_vertex = v;
+        }
+        if (w > *max_vertex)
+        {
+            *max_vertex = w;
+        }
+        p = next_line(eol, end);
+    }
+    return true;
+}
+
+/* The input is cut into one chunk per thread at line boundaries, and
+   every chunk is parsed into its own name table and edge list. The
+   tables are then merged in chunk order, which gives each name the
+   number it would get from a single pass over the whole file. Graphs
+   with numbered vertices skip the name tables altogether.  */
+
+#define PARALLEL_MIN_BYTES (1 << 20)
+
+struct chunk
+{
+    const char *begin, *end;
+    size_t num_lines, first_line;
+    struct names names;
+    struct edge_list edges;
+    vertex max_vertex;		// largest vertex number, or NULL_VERTEX
+    bool not_integers;
+    vertex *global;		// local vertex -> merged vertex
+};
+
+struct chunked_read
+{
+    struct chunk *chunks;
+    bool integers;
+};
+
+static void count_lines(void *arg, unsigned i)
+{
+    struct chunk *c = &((struct chunked_read *) arg)->chunks[i];
+    size_t lines = 0;
+    for (const char *p = c->begin; (p = memchr(p, '\n', c->end - p)); ++p)
+    {
+        ++lines;
+    }
+    c->num_lines = lines;
+}
+
+static void parse_chunk(void *arg, unsigned i)
+{
+    struct chunked_read *r = arg;
+    struct chunk *c = &r->chunks[i];
+    edge_list_init(&c->edges);
+    if (r->integers)
+    {
+        c->max_vertex = NULL_VERTEX;
+        c->not_integers = !parse_range_integers(c->begin, c->end, c->first_line,
+                                                &c->edges, &c->max_vertex);
+    }
+    else
+    {
+        names_init(&c->names);
+        parse_range(c->begin, c->end, c->first_line, &c->names, &c->edges);
+    }
+}
+
+static void remap_chunk(void *arg, unsigned i)
+{
+    struct chunk *c = &((struct chunked_read *) arg)->chunks[i];
+    for (size_t e = 0; e < c->edges.count; ++e)
+    {
+        c->edges.edges[e][0] = c->global[c->edges.edges[e][0]];
+        c->edges.edges[e][1] = c->global[c->edges.edges[e][1]];
+    }
+    free(c->global);
+}
+
+/* Parse [P, END) in N chunks. With INTEGERS, return NULL if some
+   vertex is not a number or, without -i, some number in between is
+   not a vertex.  */
+static struct csr *parse_chunks(const char *p, const char *end, unsigned n,
+				bool integers, const char ***vertex_names)
+{
+    size_t header_lines = 0;
+    p = skip_header(p, end, &header_lines);
+
+    struct chunk chunks[n];
+    struct chunked_read r = { .chunks = chunks, .integers = integers };
+    const char *begin = p;
+    for (unsigned i = 0; i < n; ++i)
+    {
+        const char *split = end;
+        if (i + 1 < n)
+        {
+            split = p + (end - p) * (i + 1) / n;
+            split = split < begin ? begin : next_line(line_end(split, end), end);
+        }
+        chunks[i].begin = begin;
+        chunks[i].end = split;
+        chunks[i].first_line = header_lines;
+        begin = split;
+    }
+
+    // Line numbers for diagnostics.
+    if (n > 1)
+    {
+        run_threads(n, count_lines, &r);
+        for (unsigned i = 1; i < n; ++i)
+        {
+            chunks[i].first_line = chunks[i - 1].first_line + chunks[i - 1].num_lines;
+        }
+    }
+
+    run_threads(n, parse_chunk, &r);
+
+    size_t num_edges[n];
+    vertex (*edges[n])[2];
+    for (unsigned i = 0; i < n; ++i)
+    {
+        num_edges[i] = chunks[i].edges.count;
+        edges[i] = chunks[i].edges.edges;
+    }
+
+    size_t size = 0;
+    if (integers)
+    {
+        bool ok = true;
+        for (unsigned i = 0; i < n; ++i)
+        {
+            ok &= !chunks[i].not_integers;
+            if (chunks[i].max_vertex != NULL_VERTEX && chunks[i].max_vertex >= size)
+            {
+                size = chunks[i].max_vertex + 1;
+            }
+        }
+        if (!ok)
+        {
+            for (unsigned i = 0; i < n; ++i)
+            {
+                free(edges[i]);
+            }
+            return NULL;
+        }
+        *vertex_names = NULL;
+    }
+    else if (n == 1)
+    {
+        size = chunks[0].names.count;
+        *vertex_names = names_finish(&chunks[0].names);
+    }
+    else
+    {
+        struct names names;
+        names_init(&names);
+        for (unsigned i = 0; i < n; ++i)
+        {
+            struct chunk *c = &chunks[i];
+            c->global = malloc((c->names.count ? c->names.count : 1) * sizeof *c->global);
+            for (size_t v = 0; v < c->names.count; ++v)
+            {
+                const char *name = names_get(&c->names, v);
+                c->global[v] = names_intern(&names, name, strlen(name));
+            }
+            names_free(&c->names);
+        }
+        run_threads(n, remap_chunk, &r);
+        size = names.count;
+        *vertex_names = names_finish(&names);
+    }
+
+    if (size > VERTEX_MAX)
+    {
+        fprintf(stderr, "Graph has more than %zu vertices; "
+                "rebuild with a larger OCC_VERTEX_BITS\n", VERTEX_MAX);
+        exit(1);
+    }
+
+    struct csr *g = n == 1
+        ? csr_make(size, num_edges[0], edges[0])
+        : csr_make_parallel(size, n, num_edges, edges, n);
+
+    for (unsigned i = 0; i < n; ++i)
+    {
+        free(edges[i]);
+    }
+
+    // Unless asked to, only take numbers as vertices if no number is
+    // skipped, so the graph is the same as with names.
+    if (integers && !integer_ids)
+    {
+        for (size_t v = 0; v < size; ++v)
+        {
+            if (csr_degree(g, v) == 0)
+            {
+                csr_free(g);
+                return NULL;
+            }
+        }
+    }
+    return g;
+}
+
+/* Parse the text graph in [P, END), in parallel if it is large enough
+   to be worth it. Vertex names are numbers if possible; *VERTEX_NAMES
+   is then set to NULL.  */
+static struct csr *parse_text(const char *p, const char *end,
+			      const char ***vertex_names)
+{
+    unsigned n = threads > 1 && end - p >= PARALLEL_MIN_BYTES ? threads : 1;
+    struct csr *g = parse_chunks(p, end, n, true, vertex_names);
+    if (!g)
+    {
+        g = parse_chunks(p, end, n, false, vertex_names);
+    }
+
+    if (deterministic)
+    {
+        csr_sort_neighbors(g, threads);
+    }
+    return g;
+}
+
+struct csr *graph_read(FILE *stream, const char ***vertex_names)
+{
+    size_t len = 0, capacity = 1 << 16;
+    char *buf = malloc(capacity);
+    size_t n;
+    while ((n = fread(buf + len, 1, capacity - len, stream)) > 0)
+    {
+        len += n;
+        if (len == capacity)
+        {
+            capacity *= 2;
+            buf = realloc(buf, capacity);
+        }
+    }
+
+    if (graph_is_binary(buf, len))
+    {
+        fprintf(stderr, "binary graphs can only be read with -f\n");
+        exit(1);
+    }
+    struct csr *g = parse_text(buf, buf + len, vertex_names);
+    free(buf);
+    return g;
+}
+
+struct csr *graph_read_file(const char *filename, const char ***vertex_names)
+{
+    int fd = open(filename, O_RDONLY);
+    if (fd < 0)
+    {
+        return NULL;
+    }
+
+    struct stat st;
+    void *map = MAP_FAILED;
+    if (fstat(fd, &st) == 0 && S_ISREG(st.st_mode) && st.st_size > 0)
+    {
+        map = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    }
+
+    struct csr *g;
+    if (map != MAP_FAILED)
+    {
+        if (graph_is_binary(map, st.st_size))
+        {
+            // The graph keeps the mapping unless it had to be
+            // converted; names always point into it.
+            g = graph_map_binary(map, st.st_size, vertex_names);
+            if (!g->map && !*vertex_names)
+            {
+                munmap(map, st.st_size);
+            }
+        }
+        else
+        {
+            posix_madvise(map, st.st_size, POSIX_MADV_SEQUENTIAL);
+            g = parse_text(map, (const char *) map + st.st_size, vertex_names);
+            munmap(map, st.st_size);
+        }
+        close(fd);
+    }
+    else
+    {
+        // Pipes, empty files and the like.
+        FILE *stream = fdopen(fd, "r");
+        g = graph_read(stream, vertex_names);
+        fclose(stream);
+    }
+
+    return g;
+}
@@ -20,8 +20,10 @@
 #include <string.h>
 
 #include "bitvec.h"
+#include "csr.h"
 #include "graph.h"
 #include "util.h"
+#include "workspace.h"
 
 size_t graph_num_vertices(const struct graph *g)
 {
@@ -50,10 +52,40 @@ size_t graph_num_edges(const struct graph *g)
     return n / 2;
 }
 
+static inline size_t vertex_bytes(size_t capacity)
+{
+    return sizeof (struct vertex) + capacity * sizeof (vertex);
+}
+
+static struct vertex *alloc_vertices(struct graph *g, size_t n)
+{
+    struct vertex *result = arena_alloc(&g->arena, vertex_bytes(n));
+    result->deg = 0;
+    result->capacity = n;
+    return result;
+}
+
+static struct graph *alloc_graph(size_t size)
+{
+    struct graph *g = malloc(sizeof (struct graph) + size * sizeof (struct vertex *));
+    g->capacity = g->size = size;
+    arena_init(&g->arena);
+    return g;
+}
+
 struct graph *graph_copy(const struct graph *g)
 {
-    struct graph *g2 = malloc(sizeof (struct graph) + g->size * sizeof (struct vertex *));
-    g2->capacity = g2->size = g->size;
+    struct graph *g2 = alloc_graph(g->size);
+    size_t bytes = 0;
+    for (size_t i = 0; i < g->size; ++i)
+    {
+    	if (graph_vertex_exists(g, i))
+        {
+            bytes += vertex_bytes(g->vertices[i]->deg) + sizeof (void *);
+        }
+    }
+    arena_reserve(&g2->arena, bytes);
+
     for (size_t i = 0; i < g->size; ++i)
     {
     	if (!graph_vertex_exists(g, i))
@@ -62,9 +94,10 @@ struct graph *graph_copy(const struct graph *g)
     	}
         else
         {
-    	    size_t bytes = (sizeof (struct vertex) + g->vertices[i]->deg * sizeof (vertex));
-    	    g2->vertices[i] = malloc(bytes);
-    	    memcpy(g2->vertices[i], g->vertices[i], bytes);
+    	    g2->vertices[i] = alloc_vertices(g2, g->vertices[i]->deg);
+    	    g2->vertices[i]->deg = g->vertices[i]->deg;
+    	    memcpy(g2->vertices[i]->neighbors, g->vertices[i]->neighbors,
+    		   g->vertices[i]->deg * sizeof (vertex));
     	}
     }
     return g2;
@@ -89,44 +122,34 @@ struct graph *graph_grow(struct graph *g, size_t size)
 
 void graph_free(struct graph *g)
 {
-    for (size_t v = 0; v < g->size; ++v)
-    {
-    	if (graph_vertex_exists(g, v))
-        {
-    	    free(g->vertices[v]);
-        }
-    }
+    arena_free(&g->arena);
     free(g);
 }
 
+/* Blocks cannot grow in place in the arena, so a full block is
+   replaced by one of at least twice the size.  */
 static void grow_neighbors(struct graph *g, vertex v, size_t new_capacity)
 {
-    bool is_new = !graph_vertex_exists(g, v);
-    if (is_new || new_capacity > g->vertices[v]->capacity)
+    if (!graph_vertex_exists(g, v))
     {
-    	g->vertices[v] = realloc(graph_vertex_exists(g, v) ? g->vertices[v] : NULL,
-    				 sizeof (struct vertex)
-    				 + new_capacity * sizeof (vertex));
-    	g->vertices[v]->capacity = new_capacity;
-    	if (is_new)
+    	g->vertices[v] = alloc_vertices(g, new_capacity);
+    }
+    else if (new_capacity > g->vertices[v]->capacity)
+    {
+        struct vertex *old = g->vertices[v];
+        if (new_capacity < 2 * old->capacity)
         {
-    	    g->vertices[v]->deg = 0;
+            new_capacity = 2 * old->capacity;
         }
+    	g->vertices[v] = alloc_vertices(g, new_capacity);
+    	g->vertices[v]->deg = old->deg;
+    	memcpy(g->vertices[v]->neighbors, old->neighbors, old->deg * sizeof (vertex));
     }
 }
 
-static struct vertex *malloc_vertices(size_t n)
-{
-    struct vertex *result = malloc(sizeof (vertex) * (2 + n));
-    result->deg = 0;
-    result->capacity = n;
-    return result;
-}
-
 struct graph *graph_make(size_t size)
 {
-    struct graph *g = calloc(sizeof (struct graph) + size * sizeof *g->vertices, 1);
-    g->capacity = g->size = size;
+    struct graph *g = alloc_graph(size);
     for (size_t i = 0; i < size; ++i) {
 
 	    g->vertices[i] = NULL_NEIGHBORS;
@@ -173,6 +196,21 @@ void graph_disconnect(struct graph *g, vertex v, vertex w)
     }
 }
 
+void graph_vertex_add(struct graph *g, vertex v, size_t capacity)
+{
+    assert(v < g->size);
+    // Not graph_vertex_enable: its store through a size_t pointer
+    // need not be seen by the loads below.
+    struct vertex *old = (struct vertex *) ((size_t) g->vertices[v] & ~(size_t) 1);
+    if (g->vertices[v] != NULL_NEIGHBORS && old->capacity >= capacity)
+    {
+        old->deg = 0;
+        g->vertices[v] = old;
+        return;
+    }
+    g->vertices[v] = alloc_vertices(g, capacity);
+}
+
 void graph_vertex_disable(struct graph *g, vertex v)
 {
     ((size_t *) g->vertices)[v] |= (size_t) 1;
@@ -183,30 +221,34 @@ void graph_vertex_enable(struct graph *g, vertex v)
     ((size_t *) g->vertices)[v] &= ~(size_t) 1;
 }
 
+/* The neighbor blocks of the subgraphs below are sized by the degree
+   in the original graph, which saves counting the neighbors inside S
+   and leaves room for edges added later. All blocks are carved out of
+   one reserved region, in vertex order.  */
 struct graph *graph_subgraph(const struct graph *g, const struct bitvec *s)
 {
     size_t size = g->size;
-    struct graph *sub = malloc(sizeof (struct graph) + sizeof (void *) * size);
-    sub->capacity = sub->size = size;
+    struct graph *sub = alloc_graph(size);
 
-    for (size_t v = 0; v < g->size; ++v)
+    size_t bytes = 0;
+    for (size_t v = 0; v < size; ++v)
+    {
+    	if (bitvec_get(s, v) && graph_vertex_exists(g, v))
+        {
+            bytes += vertex_bytes(g->vertices[v]->deg) + sizeof (void *);
+        }
+    }
+    arena_reserve(&sub->arena, bytes);
+
+    for (size_t v = 0; v < size; ++v)
     {
-    	size_t new_deg = 0;
     	if (!bitvec_get(s, v) || !graph_vertex_exists(g, v))
         {
     	    sub->vertices[v] = NULL_NEIGHBORS;
     	}
         else
         {
-    	    for (size_t n = 0; n < g->vertices[v]->deg; ++n)
-            {
-        		if (bitvec_get(s, g->vertices[v]->neighbors[n]))
-                {
-                    ++new_deg;
-                }
-    	    }
-
-    	    sub->vertices[v] = malloc_vertices(new_deg);
+    	    sub->vertices[v] = alloc_vertices(sub, g->vertices[v]->deg);
     	    for (size_t n = 0; n < g->vertices[v]->deg; ++n)
             {
         		vertex w =g->vertices[v]->neighbors[n];
@@ -220,35 +262,78 @@ struct graph *graph_subgraph(const struct graph *g, const struct bitvec *s)
     return sub;
 }
 
-bool graph_two_coloring(const struct graph *g, struct bitvec *colors)
+/* Like graph_subgraph, but starting from the read-only input graph.
+   The result has SIZE slots so callers can add vertices without an
+   immediate graph_grow.  */
+struct graph *graph_from_csr(const struct csr *c, const struct bitvec *s,
+			     size_t size)
+{
+    assert(size >= csr_size(c));
+    struct graph *g = graph_make(size);
+
+    size_t bytes = 0;
+    for (size_t v = 0; v < csr_size(c); ++v)
+    {
+    	if (bitvec_get(s, v))
+        {
+            bytes += vertex_bytes(csr_degree(c, v)) + sizeof (void *);
+        }
+    }
+    arena_reserve(&g->arena, bytes);
+
+    for (size_t v = 0; v < csr_size(c); ++v)
+    {
+    	if (!bitvec_get(s, v))
+        {
+            continue;
+        }
+
+        g->vertices[v] = alloc_vertices(g, csr_degree(c, v));
+        vertex w;
+        CSR_NEIGHBORS_ITER(c, v, w)
+        {
+            if (bitvec_get(s, w))
+            {
+                g->vertices[v]->neighbors[g->vertices[v]->deg++] = w;
+            }
+        }
+    }
+
+    return g;
+}
+
+bool graph_two_coloring(const struct graph *g, struct bitvec *colors,
+			struct workspace *ws)
 {
     size_t size = graph_size(g);
-    assert(colors->num_bits >= size);
-    ALLOCA_BITVEC(seen, size);
-    vertex queue[size];
+    assert(colors->num_bits >= size && ws->capacity >= size);
+    workspace_begin(ws);
+    vertex *queue = ws->queue;
     vertex *qhead = queue, *qtail = queue;
+    size_t num_seen = 0;
 
     for (size_t v0 = 0; v0 < size; ++v0)
     {
-    	if (!graph_vertex_exists(g, v0) || bitvec_get(seen, v0))
+    	if (!graph_vertex_exists(g, v0) || workspace_marked(ws, ws->seen, v0))
         {
     	    continue;
         }
     	assert(qtail <= queue + size);
     	*qtail++ = v0;
-    	bitvec_set(seen, v0);
+    	workspace_mark(ws, ws->seen, v0);
     	do
         {
     	    vertex v = *qhead++, w;
     	    bool c = bitvec_get(colors, v);
+    	    ++num_seen;
     	    GRAPH_NEIGHBORS_ITER(g, v, w)
             {
-        		if (!bitvec_get(seen, w))
+        		if (!workspace_marked(ws, ws->seen, w))
                 {
         		    bitvec_put(colors, w, !c);
         		    assert(qtail < queue + size);
         		    *qtail++ = w;
-        		    bitvec_set(seen, w);
+        		    workspace_mark(ws, ws->seen, w);
         		}
                 else
                 {
@@ -258,14 +343,16 @@ bool graph_two_coloring(const struct graph *g, struct bitvec *colors)
     	    }
     	} while (qhead != qtail);
     }
-    assert (bitvec_count(seen) == graph_num_vertices(g));
+    assert (num_seen == graph_num_vertices(g));
     return true;
 }
 
-bool graph_is_bipartite(const struct graph *g)
+bool graph_is_bipartite(const struct graph *g, struct workspace *ws)
 {
-    ALLOCA_BITVEC(colors, g->size);
-    return graph_two_coloring(g, colors);
+    struct bitvec *colors = bitvec_make(g->size);
+    bool bipartite = graph_two_coloring(g, colors, ws);
+    bitvec_free(colors);
+    return bipartite;
 }
 
 void graph_output(const struct graph *g, FILE *stream, const char **vertices)
@@ -306,101 +393,3 @@ void graph_output(const struct graph *g, FILE *stream, const char **vertices)
     }
     fprintf(stream, "}\n");
 }
-
-static int pstrcmp(const void *p1, const void *p2)
-{
-    return strcmp(*(const char **) p1, *(const char **) p2);
-}
-
-struct graph *graph_read(FILE *stream, const char ***vertex_names)
-{
-    size_t line_capacity = 0, line_num = 0;
-    char *line = NULL;
-    size_t num_names = 0, names_capacity = 16;
-    const char **names = malloc(names_capacity * sizeof *names);
-    size_t num_edges = 0, edges_capacity = 64;
-    struct edge { const char *v[2]; } *edges = malloc(edges_capacity * sizeof *edges);
-
-    while (get_line(&line, &line_capacity, stream))
-    {
-    	++line_num;
-    	// Special hack for Sebastian's graph format.
-    	if (strncmp("# Graph Name", line, strlen("# Graph Name")) == 0)
-        {
-    	    do
-            {
-        		get_line(&line, &line_capacity, stream);
-        		++line_num;
-    	    } while (strncmp("# Edges", line, strlen("# Edges")) != 0);
-    	    continue;
-    	}
-    	const char *name[2];
-    	name[0] = strtok(line, WHITESPACE);
-        if (!name[0] || name[0][0] == '#')
-        {
-            continue;
-        }
-        name[1] = strtok(NULL, WHITESPACE);
-        if (!name[1] || name[1][0] == '#')
-        {
-            fprintf(stderr, "Syntax error on line %zu\n", line_num);
-            exit(1);
-        }
-        const char *rest = strtok(NULL, WHITESPACE);
-        if (rest && rest[0] != '#')
-        {
-            fprintf(stderr, "warning: ignoring trailing garbage on line %zu\n",
-		    line_num);
-        }
-
-    	// This is O(n^2) or so, but anything better seems like overkill.
-    	for (size_t i = 0; i < 2; i++)
-        {
-    	    const char **p;
-    	    if ((p = bsearch(&name[i], names, num_names, sizeof *names, pstrcmp)))
-            {
-    		    name[i] = *p;
-    	    }
-            else
-            {
-        		if (num_names >= names_capacity)
-                {
-        		    names_capacity *= 2;
-        		    names = realloc(names, names_capacity * sizeof *names);
-        		}
-        		name[i] = dup_str(name[i]);
-        		names[num_names++] = name[i];
-        		qsort(names, num_names, sizeof *names, pstrcmp);
-    	    }
-    	}
-
-    	if (num_edges >= edges_capacity)
-        {
-    	    edges_capacity *= 2;
-    	    edges = realloc(edges, edges_capacity * sizeof *edges);
-    	}
-    	edges[num_edges++] = (struct edge) { {name[0], name[1]} };
-    }
-
-    struct graph *g = graph_make(num_names);
-
-    // fprintf(stdout, "Vertex indices:\n");
-
-    for (size_t i = 0; i < num_edges; ++i)
-    {
-    	vertex v[2];
-    	for (size_t j = 0; j < 2; ++j)
-        {
-    	    const char **p = bsearch(&edges[i].v[j], names, num_names,
-    				     sizeof *names, pstrcmp);
-    	    v[j] = p - names;
-    	}
-    	graph_connect(g, v[0], v[1]);
-        //fprintf(stdout, "%zd %zd\n", v[0], v[1]);
-    }
-
-    free(edges);
-    *vertex_names = names;
-
-    return g;
-}
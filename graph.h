@@ -22,23 +22,53 @@
 #include <assert.h>
 #include <stdbool.h>
 #include <stddef.h>
+#include <stdint.h>
 #include <stdio.h>
 
-struct bitvec;
+#include "arena.h"
 
-/* uint16_t would do, but seems to be slower in benchmarks.  */
-typedef size_t vertex;
+struct bitvec;
+struct csr;
+struct workspace;
+
+/* Width of vertex numbers, chosen at build time with
+   OCC_VERTEX_BITS=16, 32 or 64. Narrower vertices halve or quarter the
+   memory for adjacency lists, flow paths and BFS queues, at the price
+   of a smaller maximum graph size.  */
+#ifndef OCC_VERTEX_BITS
+#define OCC_VERTEX_BITS 64
+#endif
+
+#if OCC_VERTEX_BITS == 16
+#define VERTEX_TYPE uint16_t
+#elif OCC_VERTEX_BITS == 32
+#define VERTEX_TYPE uint32_t
+#elif OCC_VERTEX_BITS == 64
+#define VERTEX_TYPE size_t
+#else
+#error "OCC_VERTEX_BITS must be 16, 32 or 64"
+#endif
+
+typedef VERTEX_TYPE vertex;
+
+/* Largest number of vertices of an input graph. H has up to twice as
+   many, and the flow code numbers the in- and out-port of each of
+   those, so four times this must still fit into a vertex.  */
+#define VERTEX_MAX ((size_t) ((vertex) -1 / 4 - 1))
 
 #define NULL_NEIGHBORS ((struct vertex *) (size_t) 1)
 
+/* The neighbor blocks of all vertices live in ARENA, so freeing a
+   graph does not need to visit them.  */
 struct graph {
     size_t capacity;
     size_t size;
+    struct arena arena;
     struct vertex {
-        /* This used to be vertex, not int */
-	    size_t capacity;
-	    size_t deg;
-	    size_t neighbors[];
+        /* Not vertex, which would name this struct in C++.  */
+	    VERTEX_TYPE capacity;
+	    VERTEX_TYPE deg;
+	    VERTEX_TYPE neighbors[];
     } *vertices[];
 };
 
@@ -59,6 +89,8 @@ struct graph *graph_make(size_t n);
 struct graph *graph_copy(const struct graph *g);
 struct graph *graph_grow(struct graph *g, size_t size);
 struct graph *graph_subgraph(const struct graph *g, const struct bitvec *s);
+struct graph *graph_from_csr(const struct csr *c, const struct bitvec *s,
+			     size_t size);
 void graph_free(struct graph *g);
 
 static inline size_t graph_size(const struct graph *g) { return g->size; }
@@ -68,11 +100,15 @@ static inline bool graph_vertex_exists(const struct graph *g, vertex v) {
     assert(v < g->size);
     return ((size_t) g->vertices[v] & 1) == 0;
 }
-bool graph_is_bipartite(const struct graph *g);
-bool graph_two_coloring(const struct graph *g, struct bitvec *colors);
+bool graph_is_bipartite(const struct graph *g, struct workspace *ws);
+bool graph_two_coloring(const struct graph *g, struct bitvec *colors,
+			struct workspace *ws);
 
 void graph_connect(struct graph *g, vertex v, vertex w);
 void graph_disconnect(struct graph *g, vertex v, vertex w);
+/* Make V a vertex without neighbors but with room for CAPACITY of
+   them, reusing the block it had before if that is large enough.  */
+void graph_vertex_add(struct graph *g, vertex v, size_t capacity);
 void graph_vertex_disable(struct graph *g, vertex v);
 void graph_vertex_enable(struct graph *g, vertex v);
 
@@ -83,6 +119,15 @@ static inline void graph_print(const struct graph *g, const char **vertices) {
 static inline void graph_dump(const struct graph *g, const char **vertices) {
     graph_output(g, stderr, vertices);
 }
-struct graph *graph_read(FILE* stream, const char ***vertices_out);
+struct csr *graph_read(FILE* stream, const char ***vertices_out);
+/* Like graph_read, but maps the file into memory and tokenizes it in
+   place. Returns NULL if FILENAME cannot be opened.  */
+struct csr *graph_read_file(const char *filename, const char ***vertices_out);
+
+/* Versioned binary graph format (see graph-binary.c). graph_read_file
+   recognizes it by its magic number.  */
+bool graph_is_binary(const void *data, size_t len);
+bool graph_write_binary(const struct csr *g, const char **vertices, FILE *stream);
+struct csr *graph_map_binary(void *map, size_t len, const char ***vertices_out);
 
 #endif // GRAPH_H
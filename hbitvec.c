@@ -0,0 +1,201 @@
+/* occ -- find minimum odd cycle covers (Graph Bipartization)
+   Copyright (C) 2006 Falk Hueffner
+
+   This program is free software; you can redistribute it and/or
+   modify it under the terms of the GNU General Public License as
+   published by the Free Software Foundation; either version 2 of
+   the License, or (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with GCC; see the file COPYING.  If not, write to the Free
+   Software Foundation, 51 Franklin Street, Fifth Floor, Boston, MA
+   02110-1301, USA.  */
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "hbitvec.h"
+
+#define BITMAP_WORDS (HBITVEC_CHUNK_SIZE / BITS_PER_WORD)
+
+struct hbitvec *hbitvec_make(size_t num_bits)
+{
+    size_t num_chunks = (num_bits + HBITVEC_CHUNK_SIZE - 1) >> HBITVEC_CHUNK_BITS;
+    struct hbitvec *h = calloc(sizeof *h + num_chunks * sizeof *h->chunks, 1);
+    h->num_bits = num_bits;
+    h->num_chunks = num_chunks;
+    return h;
+}
+
+void hbitvec_free(struct hbitvec *h)
+{
+    for (size_t i = 0; i < h->num_chunks; ++i)
+    {
+        free(h->chunks[i].array);
+        free(h->chunks[i].bitmap);
+    }
+    free(h);
+}
+
+void hbitvec_clear(struct hbitvec *h)
+{
+    for (size_t i = 0; i < h->num_chunks; ++i)
+    {
+        struct hbitvec_chunk *c = &h->chunks[i];
+        if (c->count && c->bitmap)
+        {
+            memset(c->bitmap, 0, BITMAP_WORDS * sizeof *c->bitmap);
+        }
+        c->count = 0;
+    }
+    h->count = 0;
+}
+
+/* Index of the first element of C's array that is >= LOW.  */
+static size_t array_lower_bound(const struct hbitvec_chunk *c, uint16_t low)
+{
+    size_t lo = 0, hi = c->count;
+    while (lo < hi)
+    {
+        size_t mid = (lo + hi) / 2;
+        if (c->array[mid] < low)
+        {
+            lo = mid + 1;
+        }
+        else
+        {
+            hi = mid;
+        }
+    }
+    return lo;
+}
+
+bool hbitvec_array_get(const struct hbitvec_chunk *c, uint16_t low)
+{
+    size_t i = array_lower_bound(c, low);
+    return i < c->count && c->array[i] == low;
+}
+
+static void array_to_bitmap(struct hbitvec_chunk *c)
+{
+    c->bitmap = calloc(BITMAP_WORDS, sizeof *c->bitmap);
+    for (size_t i = 0; i < c->count; ++i)
+    {
+        c->bitmap[c->array[i] / BITS_PER_WORD] |= 1UL << (c->array[i] % BITS_PER_WORD);
+    }
+    free(c->array);
+    c->array = NULL;
+    c->capacity = 0;
+}
+
+void hbitvec_set(struct hbitvec *h, size_t n)
+{
+    assert(n < h->num_bits);
+    struct hbitvec_chunk *c = &h->chunks[n >> HBITVEC_CHUNK_BITS];
+    uint16_t low = n & (HBITVEC_CHUNK_SIZE - 1);
+    if (!c->bitmap)
+    {
+        size_t i = array_lower_bound(c, low);
+        if (i < c->count && c->array[i] == low)
+        {
+            return;
+        }
+        if (c->count < HBITVEC_ARRAY_MAX)
+        {
+            if (c->count == c->capacity)
+            {
+                c->capacity = c->capacity ? 2 * c->capacity : 4;
+                c->array = realloc(c->array, c->capacity * sizeof *c->array);
+            }
+            memmove(c->array + i + 1, c->array + i, (c->count - i) * sizeof *c->array);
+            c->array[i] = low;
+            c->count++;
+            h->count++;
+            return;
+        }
+        array_to_bitmap(c);
+    }
+
+    unsigned long *word = &c->bitmap[low / BITS_PER_WORD];
+    unsigned long bit = 1UL << (low % BITS_PER_WORD);
+    if (!(*word & bit))
+    {
+        *word |= bit;
+        c->count++;
+        h->count++;
+    }
+}
+
+void hbitvec_unset(struct hbitvec *h, size_t n)
+{
+    assert(n < h->num_bits);
+    struct hbitvec_chunk *c = &h->chunks[n >> HBITVEC_CHUNK_BITS];
+    uint16_t low = n & (HBITVEC_CHUNK_SIZE - 1);
+    if (c->bitmap)
+    {
+        // Bitmaps stay bitmaps; sets that once got large tend to again.
+        unsigned long *word = &c->bitmap[low / BITS_PER_WORD];
+        unsigned long bit = 1UL << (low % BITS_PER_WORD);
+        if (*word & bit)
+        {
+            *word &= ~bit;
+            c->count--;
+            h->count--;
+        }
+        return;
+    }
+
+    size_t i = array_lower_bound(c, low);
+    if (i < c->count && c->array[i] == low)
+    {
+        memmove(c->array + i, c->array + i + 1, (c->count - i - 1) * sizeof *c->array);
+        c->count--;
+        h->count--;
+    }
+}
+
+size_t hbitvec_find(const struct hbitvec *h, size_t n)
+{
+    for (size_t chunk = n >> HBITVEC_CHUNK_BITS; chunk < h->num_chunks; ++chunk)
+    {
+        const struct hbitvec_chunk *c = &h->chunks[chunk];
+        size_t base = chunk << HBITVEC_CHUNK_BITS;
+        size_t low = n > base ? n - base : 0;
+        if (c->count == 0)
+        {
+            continue;
+        }
+
+        if (c->bitmap)
+        {
+            size_t w = low / BITS_PER_WORD;
+            unsigned long word = c->bitmap[w] & (~0UL << (low % BITS_PER_WORD));
+            while (true)
+            {
+                if (word)
+                {
+                    return base + w * BITS_PER_WORD + ctzl(word);
+                }
+                if (++w == BITMAP_WORDS)
+                {
+                    break;
+                }
+                word = c->bitmap[w];
+            }
+        }
+        else
+        {
+            size_t i = array_lower_bound(c, low);
+            if (i < c->count)
+            {
+                return base + c->array[i];
+            }
+        }
+    }
+    return BITVEC_NOT_FOUND;
+}
@@ -0,0 +1,87 @@
+/* occ -- find minimum odd cycle covers (Graph Bipartization)
+   Copyright (C) 2006 Falk Hueffner
+
+   This program is free software; you can redistribute it and/or
+   modify it under the terms of the GNU General Public License as
+   published by the Free Software Foundation; either version 2 of
+   the License, or (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with GCC; see the file COPYING.  If not, write to the Free
+   Software Foundation, 51 Franklin Street, Fifth Floor, Boston, MA
+   02110-1301, USA.  */
+
+#ifndef HBITVEC_H
+#define HBITVEC_H
+
+#include <assert.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "bitvec.h"
+
+/* Hybrid bit vector for sets that are usually small compared to their
+   universe, such as the flow sources and targets or a cut. The bits
+   are split into chunks of 2^16 (as in roaring bitmaps); a chunk holds
+   a sorted array of its set bits until that gets larger than a dense
+   bitmap would be. Clearing, counting and iterating cost O(chunks +
+   set bits) rather than O(bits).  */
+
+#define HBITVEC_CHUNK_BITS 16
+#define HBITVEC_CHUNK_SIZE ((size_t) 1 << HBITVEC_CHUNK_BITS)
+#define HBITVEC_ARRAY_MAX 4096	// as many bytes as the bitmap
+
+struct hbitvec_chunk {
+    uint32_t count;		// set bits in this chunk
+    uint32_t capacity;		// of array
+    uint16_t *array;		// sorted set bits, if bitmap is NULL
+    unsigned long *bitmap;	// HBITVEC_CHUNK_SIZE bits, or NULL
+};
+
+struct hbitvec {
+    size_t num_bits;
+    size_t count;
+    size_t num_chunks;
+    struct hbitvec_chunk chunks[];
+};
+
+struct hbitvec *hbitvec_make(size_t num_bits);
+void hbitvec_free(struct hbitvec *h);
+void hbitvec_clear(struct hbitvec *h);
+
+void hbitvec_set(struct hbitvec *h, size_t n);
+void hbitvec_unset(struct hbitvec *h, size_t n);
+bool hbitvec_array_get(const struct hbitvec_chunk *c, uint16_t low);
+
+/* Return the first set bit at or after N, or BITVEC_NOT_FOUND.  */
+size_t hbitvec_find(const struct hbitvec *h, size_t n);
+
+static inline size_t hbitvec_size(const struct hbitvec *h) {
+    return h->num_bits;
+}
+
+static inline size_t hbitvec_count(const struct hbitvec *h) {
+    return h->count;
+}
+
+static inline bool hbitvec_get(const struct hbitvec *h, size_t n) {
+    assert(n < h->num_bits);
+    const struct hbitvec_chunk *c = &h->chunks[n >> HBITVEC_CHUNK_BITS];
+    size_t low = n & (HBITVEC_CHUNK_SIZE - 1);
+    if (c->bitmap)
+    {
+	return (c->bitmap[low / BITS_PER_WORD] >> (low % BITS_PER_WORD)) & 1;
+    }
+    return c->count && hbitvec_array_get(c, low);
+}
+
+#define HBITVEC_ITER(h, n)						\
+    for (size_t n = hbitvec_find(h, 0); n != BITVEC_NOT_FOUND; n = hbitvec_find(h, n + 1))
+
+#endif // HBITVEC_H
@@ -29,13 +29,16 @@ int getopt(int argc, const char *argv[], const char *optstring);
 #include <unistd.h>
 #include <sys/times.h>
 #include <signal.h>
+#include <string.h>
 
 
 // Include local C header files
 extern "C" {
     #include "bitvec.h"
+    #include "csr.h"
     #include "graph.h"
     #include "occ.h"
+    #include "reduce.h"
 }
 
 
@@ -48,17 +51,38 @@ extern "C" {
 bool verbose    = false;
 char *graph_filename;
 int preprocessing_level = 0;
+unsigned threads = 1;
+bool deterministic = false;
+bool integer_ids = false;
+bool bidirectional_flow = false;
+bool blocking_flow = false;
+unsigned portfolio = 1;
+bool kernelize = false;
+bool decompose = false;
+enum relabel_order relabel = RELABEL_NONE;
 
 
 void usage(FILE *stream) {
     fprintf(stream,
 	    "occ: Calculate minimum odd cycle cover\n"
 	    "  -v  Print progress to stderr\n"
-        "  -f  Compute OCT on this graph file"
+        "  -b  Search augmenting paths from both ends (enum2col only)\n"
+        "  -g  Use the Gray code engine instead of enum2col\n"
+        "  -B  Augment by blocking flows of shortest paths (Gray code engine only)\n"
+        "  -c  Solve each connected component separately, on -j threads\n"
+        "  -k  Apply data reduction rules before compression\n"
+        "  -j  Number of worker threads, defaults to 1\n"
+        "  -P  Run this many compression passes in different orders concurrently\n"
+        "  -D  Deterministic mode: results do not depend on thread scheduling\n"
+        "  -i  Vertex names are numbers; use them as vertices (default: auto-detect)\n"
+        "  -f  Compute OCT on this graph file (default: standard input)\n"
 	    "  -h  Display this list of options\n"
+        "  -r  Renumber vertices for locality: none, bfs, rcm or degree (default: none)\n"
         "  -p  Preprocessing level {0: None, 1: Bipartite, 2: Bipartite + Density Sort}\n"
         "  -s  Seed for shuffling heuristic oct. Must be nonzero. No shuffle if not specified\n"
         "  -t  Time in milliseconds to run heuristics, defaults to 250 (0.24s)\n"
+        "\n"
+        "occ --convert IN OUT: Write graph file IN in binary format to OUT\n"
 	);
 }
 
@@ -68,34 +92,122 @@ int main(int argc, char *argv[]) {
     // Initialize signals
     init_signal_handler();
 
+    // Convert a graph to the binary format and exit.
+    if (argc >= 2 && strcmp(argv[1], "--convert") == 0) {
+        if (argc != 4) {
+            usage(stderr);
+            exit(1);
+        }
+        g = graph_read_file(argv[2], &vertices);
+        if (g == NULL) {
+            fprintf(stderr, "File '%s' could not be read.\n", argv[2]);
+            exit(1);
+        }
+        FILE *out = fopen(argv[3], "wb");
+        if (out == NULL || !graph_write_binary(g, vertices, out) || fclose(out) != 0) {
+            fprintf(stderr, "File '%s' could not be written.\n", argv[3]);
+            exit(1);
+        }
+        return 0;
+    }
+
     int seed = 0;
     long htime = 250;
 
     int c;
-    while ((c = getopt(argc, argv, "vhf:p:s:t:")) != -1)
+    while ((c = getopt(argc, argv, "vbBcghf:ij:kDP:p:r:s:t:")) != -1)
     {
 	    switch (c)
         {
 	        case 'v': verbose    = true; break;
+            case 'b': bidirectional_flow = true; break;
+            case 'B': blocking_flow = true; break;
+            case 'g': enum2col = false; break;
 	        case 'h': usage(stdout); exit(0); break;
             case 'f': graph_filename = optarg; break;
+            case 'i': integer_ids = true; break;
+            case 'c': decompose = true; break;
+            case 'k': kernelize = true; break;
+            case 'j': threads = atoi(optarg) > 0 ? atoi(optarg) : 1; break;
+            case 'D': deterministic = true; break;
+            case 'P': portfolio = atoi(optarg) > 0 ? atoi(optarg) : 1; break;
             case 'p': preprocessing_level = atoi(optarg); break;
+            case 'r':
+                if (!relabel_parse(optarg, &relabel)) {
+                    usage(stderr);
+                    exit(1);
+                }
+                break;
             case 's': seed = atoi(optarg); break;
             case 't': htime = atol(optarg); break;
 	        default:  usage(stderr); exit(1); break;
 	    }
     }
 
-    FILE *graph_stream = fopen(graph_filename, "r");
-    if (graph_stream == NULL) {
-        fprintf(stderr, "File '%s' could not be read.\n", graph_filename);
-        exit(1);
+    if (graph_filename == NULL) {
+        g = graph_read(stdin, &vertices);
+    }
+    else {
+        g = graph_read_file(graph_filename, &vertices);
+        if (g == NULL) {
+            fprintf(stderr, "File '%s' could not be read.\n", graph_filename);
+            exit(1);
+        }
+    }
+
+    if (verbose) {
+        size_t adjacency = (csr_size(g) + 1) * sizeof *g->offsets
+            + 2 * csr_num_edges(g) * sizeof (vertex);
+        fprintf(stderr, "%d-bit vertices, %lu bytes of adjacency, %s bitvec kernels\n",
+                OCC_VERTEX_BITS, (unsigned long) adjacency, bitvec_kernel_name());
+    }
+
+    // Solve on a renumbered copy; vertex_map translates back for output.
+    if (relabel != RELABEL_NONE) {
+        double start = user_time();
+        vertex_map = relabel_order(g, relabel);
+        struct csr *r = relabel_graph(g, vertex_map);
+        if (verbose) {
+            fprintf(stderr, "renumbered (%s) in %.2f s, mean edge span %.1f -> %.1f\n",
+                    relabel_name(relabel), user_time() - start,
+                    relabel_edge_span(g), relabel_edge_span(r));
+        }
+        // A mapped graph also holds the names.
+        if (!g->map)
+            csr_free(g);
+        g = r;
+    }
+
+    // Solve on the kernel; find_occ lifts the cover back to G.
+    const struct csr *solve = g;
+    if (kernelize) {
+        double start = user_time();
+        reduction = reduce_graph(g);
+        solve = reduction->kernel;
+        if (verbose) {
+            fprintf(stderr, "kernel: %lu vertices, %lu edges in %.2f s "
+                    "(self-loop %lu, degree <= 1 %lu, folded %lu, bipartite blocks %lu, "
+                    "merged edges %lu)\n",
+                    (unsigned long) csr_size(solve), (unsigned long) csr_num_edges(solve),
+                    user_time() - start,
+                    (unsigned long) reduce_count(reduction, REDUCE_SELF_LOOP),
+                    (unsigned long) reduce_count(reduction, REDUCE_LOW_DEGREE),
+                    (unsigned long) reduce_count(reduction, REDUCE_FOLD),
+                    (unsigned long) reduce_count(reduction, REDUCE_BIPARTITE_BLOCK),
+                    (unsigned long) reduction->num_merged);
+        }
     }
-    g = graph_read(graph_stream, &vertices);
-    fclose(graph_stream);
 
     /* Find OCT and return */
-    find_occ(g, preprocessing_level, seed, htime);
+    int cache_misses = verbose ? perf_cache_misses_start() : -1;
+    find_occ(solve, preprocessing_level, seed, htime);
+    if (verbose) {
+        long long misses = perf_cache_misses_stop(cache_misses);
+        if (misses >= 0)
+            fprintf(stderr, "%lld cache misses while solving\n", misses);
+        else
+            fprintf(stderr, "cache miss counter not available\n");
+    }
     return 0;
 
 }
@@ -0,0 +1,133 @@
+/* occ -- find minimum odd cycle covers (Graph Bipartization)
+   Copyright (C) 2006 Falk Hueffner
+
+   This program is free software; you can redistribute it and/or
+   modify it under the terms of the GNU General Public License as
+   published by the Free Software Foundation; either version 2 of
+   the License, or (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with GCC; see the file COPYING.  If not, write to the Free
+   Software Foundation, 51 Franklin Street, Fifth Floor, Boston, MA
+   02110-1301, USA.  */
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "names.h"
+
+#define INITIAL_SLOTS 64
+
+// FNV-1a.
+static size_t hash_name(const char *s, size_t len)
+{
+    size_t h = (size_t) 14695981039346656037ULL;
+    for (size_t i = 0; i < len; ++i)
+    {
+        h ^= (unsigned char) s[i];
+        h *= (size_t) 1099511628211ULL;
+    }
+    return h;
+}
+
+void names_init(struct names *names)
+{
+    names->count = 0;
+    names->mask = INITIAL_SLOTS - 1;
+    names->slots = calloc(INITIAL_SLOTS, sizeof *names->slots);
+    names->offsets_capacity = INITIAL_SLOTS / 2;
+    names->hashes = malloc(names->offsets_capacity * sizeof *names->hashes);
+    names->offsets = malloc(names->offsets_capacity * sizeof *names->offsets);
+    names->pool_size = 0;
+    names->pool_capacity = 1024;
+    names->pool = malloc(names->pool_capacity);
+}
+
+void names_free(struct names *names)
+{
+    free(names->slots);
+    free(names->hashes);
+    free(names->offsets);
+    free(names->pool);
+}
+
+static void rehash(struct names *names)
+{
+    size_t num_slots = 2 * (names->mask + 1);
+    free(names->slots);
+    names->slots = calloc(num_slots, sizeof *names->slots);
+    names->mask = num_slots - 1;
+    for (size_t v = 0; v < names->count; ++v)
+    {
+        size_t i = names->hashes[v] & names->mask;
+        while (names->slots[i])
+        {
+            i = (i + 1) & names->mask;
+        }
+        names->slots[i] = v + 1;
+    }
+}
+
+vertex names_intern(struct names *names, const char *s, size_t len)
+{
+    size_t h = hash_name(s, len);
+    size_t i = h & names->mask;
+    while (names->slots[i])
+    {
+        vertex v = names->slots[i] - 1;
+        const char *t = names->pool + names->offsets[v];
+        if (names->hashes[v] == h && memcmp(t, s, len) == 0 && t[len] == '\0')
+        {
+            return v;
+        }
+        i = (i + 1) & names->mask;
+    }
+
+    vertex v = names->count++;
+    if (names->count > names->offsets_capacity)
+    {
+        names->offsets_capacity *= 2;
+        names->hashes = realloc(names->hashes,
+                                names->offsets_capacity * sizeof *names->hashes);
+        names->offsets = realloc(names->offsets,
+                                 names->offsets_capacity * sizeof *names->offsets);
+    }
+    while (names->pool_size + len + 1 > names->pool_capacity)
+    {
+        names->pool_capacity *= 2;
+        names->pool = realloc(names->pool, names->pool_capacity);
+    }
+    memcpy(names->pool + names->pool_size, s, len);
+    names->pool[names->pool_size + len] = '\0';
+    names->hashes[v] = h;
+    names->offsets[v] = names->pool_size;
+    names->pool_size += len + 1;
+
+    // Keep the load factor at most 1/2.
+    if (2 * names->count > names->mask + 1)
+    {
+        rehash(names);
+    }
+    else
+    {
+        names->slots[i] = v + 1;
+    }
+    return v;
+}
+
+const char **names_finish(struct names *names)
+{
+    const char **result = malloc((names->count ? names->count : 1) * sizeof *result);
+    for (size_t v = 0; v < names->count; ++v)
+    {
+        result[v] = names->pool + names->offsets[v];
+    }
+    names->pool = NULL;
+    names_free(names);
+    return result;
+}
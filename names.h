@@ -0,0 +1,57 @@
+/* occ -- find minimum odd cycle covers (Graph Bipartization)
+   Copyright (C) 2006 Falk Hueffner
+
+   This program is free software; you can redistribute it and/or
+   modify it under the terms of the GNU General Public License as
+   published by the Free Software Foundation; either version 2 of
+   the License, or (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with GCC; see the file COPYING.  If not, write to the Free
+   Software Foundation, 51 Franklin Street, Fifth Floor, Boston, MA
+   02110-1301, USA.  */
+
+#ifndef NAMES_H
+#define NAMES_H
+
+#include <stddef.h>
+
+#include "graph.h"
+
+/* Interning table for vertex names. Each distinct name is copied once
+   into a contiguous string pool and gets the next free vertex number,
+   so numbers follow the order in which names are first seen. Lookup
+   is by open addressing with linear probing.  */
+struct names {
+    size_t count;		// number of distinct names
+    size_t mask;		// hash table size - 1
+    size_t *slots;		// vertex + 1 per slot, 0 if empty
+    size_t *hashes;		// hash of each name, by vertex
+    size_t *offsets;		// start of each name in pool, by vertex
+    size_t offsets_capacity;
+    char *pool;
+    size_t pool_size, pool_capacity;
+};
+
+void names_init(struct names *names);
+void names_free(struct names *names);
+
+/* Return the vertex for the LEN bytes at S, adding it if new. S need
+   not be NUL-terminated.  */
+vertex names_intern(struct names *names, const char *s, size_t len);
+
+static inline const char *names_get(const struct names *names, vertex v) {
+    return names->pool + names->offsets[v];
+}
+
+/* Return a malloced array mapping vertices to their names. The names
+   point into the pool, which is handed over to the caller together
+   with the array; everything else in NAMES is freed.  */
+const char **names_finish(struct names *names);
+
+#endif // NAMES_H
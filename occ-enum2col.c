@@ -16,16 +16,79 @@
    Software Foundation, 51 Franklin Street, Fifth Floor, Boston, MA
    02110-1301, USA.  */
 
+#include <pthread.h>
+#include <stdlib.h>
+#include <string.h>
+
 #include "bitvec.h"
 #include "flow.h"
 #include "graph.h"
+#include "hbitvec.h"
 #include "occ.h"
+#include "util.h"
+#include "workspace.h"
 
 extern bool verbose;
 extern unsigned long long augmentations;
+extern unsigned threads;
+extern bool deterministic;
 
 enum color { GREY, BLACK, WHITE, RED };
 
+/* Alternatives for the vertex branched on: its first color (forced by
+   its neighbors, or white), black, or leaving it in the cover.  */
+enum { TRY_FIRST = 1, TRY_BLACK = 2, TRY_RED = 4, TRY_ALL = 7 };
+
+/* With several threads, subtrees of the search are split off as tasks.
+   A task is the state at the entry of branch, together with the
+   alternatives still to try there. Each thread keeps its tasks in a
+   deque: it takes the newest ones itself, while idle threads steal the
+   oldest, which tend to be the largest subtrees.  */
+struct task
+{
+    unsigned alternatives;
+    size_t qhead, qtail;	// positions in queue
+    enum color *colors;
+    vertex *queue;
+    struct bitvec *in_queue;
+    struct flow *flow;
+};
+
+struct deque
+{
+    pthread_mutex_t lock;
+    struct task **tasks;
+    size_t head, tail, capacity;
+};
+
+struct pool;
+
+/* A thread with its own copy of H, the flow on it, and the branching
+   state; everything else in PROBLEM is shared read-only.  */
+struct worker
+{
+    struct pool *pool;
+    struct occ_problem problem;
+    enum color *colors;
+    vertex *queue;
+    struct bitvec *in_queue;
+    struct deque deque;
+};
+
+struct pool
+{
+    struct graph *occ_g;
+    unsigned num_workers;
+    struct worker *workers;
+    pthread_mutex_t lock;
+    pthread_cond_t changed;
+    size_t pending;		// tasks queued or running, under LOCK
+    size_t queued;		// tasks in the deques
+    unsigned idle;		// threads waiting for a task
+    bool cancel;		// a smaller cover has been found
+    struct bitvec *result;
+};
+
 static struct bitvec* assemble_occ(struct occ_problem *problem,
 				   const enum color *colors)
 {
@@ -34,19 +97,18 @@ static struct bitvec* assemble_occ(struct occ_problem *problem,
 		fprintf(stderr, "found small cut; ");
 	}
 
-    struct bitvec *occ = bitvec_make(problem->g->size);
-    ALLOCA_BITVEC(cut, problem->h->size);
-    ALLOCA_BITVEC(sources, problem->h->size);
+    struct bitvec *occ = bitvec_make(csr_view_size(problem->g));
+    struct hbitvec *sources = hbitvec_make(problem->h->size);
     for (size_t i = 0; i < problem->occ_size; ++i)
 	{
 		vertex v = problem->occ_vertices[i];
 		if (colors[i] == WHITE)
 		{
-		    bitvec_set(sources, v);
+		    hbitvec_set(sources, v);
 		}
 		else if (colors[i] == BLACK)
 		{
-		    bitvec_set(sources, problem->clones[v]);
+		    hbitvec_set(sources, problem->clones[v]);
 		}
 		else
 		{
@@ -54,16 +116,18 @@ static struct bitvec* assemble_occ(struct occ_problem *problem,
 		}
     }
 
-    cut = flow_vertex_cut(problem->flow, sources);
-    BITVEC_ITER(cut, v)
+    struct hbitvec *cut = flow_last_cut(problem->flow, problem->ws, sources);
+    HBITVEC_ITER(cut, v)
 	{
-		if (v >= problem->first_clone)
+		vertex w = v;
+		if (w >= problem->first_clone)
 		{
-		    v = problem->occ_vertices[v - problem->first_clone];
+		    w = problem->occ_vertices[w - problem->first_clone];
 		}
-		bitvec_set(occ, v);
+		bitvec_set(occ, w);
     }
-    bitvec_free(cut);
+    hbitvec_free(cut);
+    hbitvec_free(sources);
 
     return occ;
 }
@@ -90,25 +154,124 @@ static void remove_pair(struct occ_problem *problem, vertex v)
 		vertex s2 = flow_drain_target(problem->flow, t);
 		graph_vertex_disable(problem->h, s);
 		graph_vertex_disable(problem->h, t);
-		flow_augment_pair(problem->flow, s2, t2);
-		augmentations++;
+		flow_augment_pair(problem->flow, problem->ws, s2, t2);
+		__atomic_fetch_add(&augmentations, 1, __ATOMIC_RELAXED);
 		graph_vertex_enable(problem->h, s);
 		graph_vertex_enable(problem->h, t);
     }
 }
 
-static struct bitvec *branch(struct occ_problem *problem, struct graph *occ_g,
-			     enum color *colors, struct bitvec *in_queue,
-			     vertex *qhead, vertex *qtail)
+static struct task *task_make(const struct occ_problem *problem,
+			      const struct flow *flow, const enum color *colors,
+			      const struct bitvec *in_queue, const vertex *queue,
+			      const vertex *qhead, const vertex *qtail,
+			      unsigned alternatives)
+{
+    size_t k = problem->occ_size;
+    struct task *task = malloc(sizeof *task);
+    task->alternatives = alternatives;
+    task->qhead = qhead - queue;
+    task->qtail = qtail - queue;
+    task->colors = malloc(k * sizeof *task->colors);
+    memcpy(task->colors, colors, k * sizeof *task->colors);
+    task->queue = malloc(k * sizeof *task->queue);
+    memcpy(task->queue, queue, k * sizeof *task->queue);
+    task->in_queue = bitvec_clone(in_queue);
+    task->flow = flow_clone(flow);
+    return task;
+}
+
+static void task_free(struct task *task)
+{
+    free(task->colors);
+    free(task->queue);
+    bitvec_free(task->in_queue);
+    flow_free(task->flow);
+    free(task);
+}
+
+static void deque_push(struct deque *deque, struct task *task)
+{
+    pthread_mutex_lock(&deque->lock);
+    if (deque->tail == deque->capacity)
+    {
+        // Move the live part to the front before growing.
+        memmove(deque->tasks, deque->tasks + deque->head,
+                (deque->tail - deque->head) * sizeof *deque->tasks);
+        deque->tail -= deque->head;
+        deque->head = 0;
+        if (deque->tail == deque->capacity)
+        {
+            deque->capacity = deque->capacity ? 2 * deque->capacity : 16;
+            deque->tasks = realloc(deque->tasks, deque->capacity * sizeof *deque->tasks);
+        }
+    }
+    deque->tasks[deque->tail++] = task;
+    pthread_mutex_unlock(&deque->lock);
+}
+
+// Take the newest task (OLDEST false) or the oldest one, or NULL.
+static struct task *deque_take(struct deque *deque, bool oldest)
+{
+    struct task *task = NULL;
+    pthread_mutex_lock(&deque->lock);
+    if (deque->head != deque->tail)
+    {
+        task = oldest ? deque->tasks[deque->head++] : deque->tasks[--deque->tail];
+    }
+    pthread_mutex_unlock(&deque->lock);
+    return task;
+}
+
+static bool deque_empty(struct deque *deque)
+{
+    pthread_mutex_lock(&deque->lock);
+    bool empty = deque->head == deque->tail;
+    pthread_mutex_unlock(&deque->lock);
+    return empty;
+}
+
+static inline bool pool_cancelled(const struct pool *pool)
+{
+    return __atomic_load_n(&pool->cancel, __ATOMIC_RELAXED);
+}
+
+static void pool_push(struct worker *worker, struct task *task)
+{
+    struct pool *pool = worker->pool;
+    deque_push(&worker->deque, task);
+    pthread_mutex_lock(&pool->lock);
+    pool->pending++;
+    pool->queued++;
+    pthread_cond_signal(&pool->changed);
+    pthread_mutex_unlock(&pool->lock);
+}
+
+static struct bitvec *branch(struct occ_problem *problem, struct worker *worker,
+			     struct graph *occ_g, enum color *colors,
+			     struct bitvec *in_queue, vertex *qhead, vertex *qtail,
+			     unsigned alternatives)
 {
 
 	// Dereference the problem interrupt pointer. If interrupt is true,
 	// we will stop branching immediately and just return NULL indicating
 	// that we didn't find an answer.
-	if (*problem->interrupt) {
+	if (*problem->interrupt || (worker && pool_cancelled(worker->pool))) {
 		return NULL;
 	}
 
+    // Hand the other alternatives to a thread that has run out of work,
+    // unless it can already take older tasks from us.
+    if (worker && (alternatives & TRY_FIRST) && alternatives != TRY_FIRST
+        && __atomic_load_n(&worker->pool->idle, __ATOMIC_RELAXED) > 0
+        && deque_empty(&worker->deque))
+    {
+        pool_push(worker, task_make(problem, problem->flow, colors, in_queue,
+                                    worker->queue, qhead, qtail,
+                                    alternatives & ~TRY_FIRST));
+        alternatives = TRY_FIRST;
+    }
+
     ALLOCA_U_BITVEC(in_queue_backup, occ_g->size);
     bitvec_copy(in_queue_backup, in_queue);
     vertex *qtail_backup = qtail;
@@ -191,30 +354,40 @@ static struct bitvec *branch(struct occ_problem *problem, struct graph *occ_g,
 		s = v2, t = v;
 	}
 
-	augmentations++;
-    if (!flow_augment_pair(problem->flow, s, t))
-	{
-		return assemble_occ(problem, colors);
-	}
-
+    // Whether the flow holds a path for the pair of v.
+    bool has_pair = false;
     struct bitvec *new_occ;
-    if ((new_occ = branch(problem, occ_g, colors, in_queue, qhead, qtail)))
+    if (alternatives & TRY_FIRST)
 	{
-		return new_occ;
+		__atomic_fetch_add(&augmentations, 1, __ATOMIC_RELAXED);
+		if (!flow_augment_pair(problem->flow, problem->ws, s, t))
+		{
+			return assemble_occ(problem, colors);
+		}
+		has_pair = true;
+
+		if ((new_occ = branch(problem, worker, occ_g, colors, in_queue, qhead, qtail, TRY_ALL)))
+		{
+			return new_occ;
+		}
 	}
 
-    if (was_grey)
+    if (was_grey && (alternatives & TRY_BLACK))
 	{
 		// 2nd branch.
-		remove_pair(problem, v);
+		if (has_pair)
+		{
+			remove_pair(problem, v);
+		}
 		colors[i] = BLACK;
-		augmentations++;
-		if (!flow_augment_pair(problem->flow, v2, v))
+		__atomic_fetch_add(&augmentations, 1, __ATOMIC_RELAXED);
+		if (!flow_augment_pair(problem->flow, problem->ws, v2, v))
 		{
 		    return assemble_occ(problem, colors);
 		}
+		has_pair = true;
 
-		if ((new_occ = branch(problem, occ_g, colors, in_queue, qhead, qtail)))
+		if ((new_occ = branch(problem, worker, occ_g, colors, in_queue, qhead, qtail, TRY_ALL)))
 		{
 		    return new_occ;
 		}
@@ -222,16 +395,22 @@ static struct bitvec *branch(struct occ_problem *problem, struct graph *occ_g,
 
     bitvec_copy(in_queue, in_queue_backup);
     qtail = qtail_backup;
-    remove_pair(problem, v);
+    if (has_pair)
+	{
+		remove_pair(problem, v);
+	}
     graph_vertex_disable(problem->h, v);
     graph_vertex_disable(problem->h, v2);
 
 try_red:
-    colors[i] = RED;
-    assert(!graph_vertex_exists(problem->h, v));
-    if ((new_occ = branch(problem, occ_g, colors, in_queue, qhead, qtail)))
+    if (alternatives & TRY_RED)
 	{
-		return new_occ;
+		colors[i] = RED;
+		assert(!graph_vertex_exists(problem->h, v));
+		if ((new_occ = branch(problem, worker, occ_g, colors, in_queue, qhead, qtail, TRY_ALL)))
+		{
+			return new_occ;
+		}
 	}
 	colors[i] = GREY;
     if (did_enqueue)
@@ -241,6 +420,146 @@ try_red:
     return NULL;
 }
 
+static void run_task(struct worker *worker, struct task *task)
+{
+    struct occ_problem *problem = &worker->problem;
+    size_t k = problem->occ_size;
+    memcpy(worker->colors, task->colors, k * sizeof *worker->colors);
+    memcpy(worker->queue, task->queue, k * sizeof *worker->queue);
+    bitvec_copy(worker->in_queue, task->in_queue);
+    flow_copy(problem->flow, task->flow);
+    // A pair is in H exactly when its vertex is colored.
+    for (size_t i = 0; i < k; ++i)
+    {
+        vertex v = problem->occ_vertices[i], v2 = problem->first_clone + i;
+        if (worker->colors[i] == WHITE || worker->colors[i] == BLACK)
+        {
+            graph_vertex_enable(problem->h, v);
+            graph_vertex_enable(problem->h, v2);
+        }
+        else
+        {
+            graph_vertex_disable(problem->h, v);
+            graph_vertex_disable(problem->h, v2);
+        }
+    }
+
+    struct bitvec *occ = branch(problem, worker, worker->pool->occ_g,
+                                worker->colors, worker->in_queue,
+                                worker->queue + task->qhead,
+                                worker->queue + task->qtail, task->alternatives);
+    task_free(task);
+
+    struct pool *pool = worker->pool;
+    pthread_mutex_lock(&pool->lock);
+    if (occ && !pool->result)
+    {
+        pool->result = occ;
+        __atomic_store_n(&pool->cancel, true, __ATOMIC_RELAXED);
+    }
+    else if (occ)
+    {
+        bitvec_free(occ);
+    }
+    if (--pool->pending == 0 || pool->cancel)
+    {
+        pthread_cond_broadcast(&pool->changed);
+    }
+    pthread_mutex_unlock(&pool->lock);
+}
+
+static void worker_main(void *arg, unsigned id)
+{
+    struct pool *pool = arg;
+    struct worker *worker = &pool->workers[id];
+    while (true)
+    {
+        struct task *task = deque_take(&worker->deque, false);
+        for (unsigned j = 1; !task && j < pool->num_workers; ++j)
+        {
+            task = deque_take(&pool->workers[(id + j) % pool->num_workers].deque, true);
+        }
+        if (task)
+        {
+            pthread_mutex_lock(&pool->lock);
+            pool->queued--;
+            pthread_mutex_unlock(&pool->lock);
+            run_task(worker, task);
+            continue;
+        }
+
+        pthread_mutex_lock(&pool->lock);
+        if (pool->pending == 0)
+        {
+            pthread_mutex_unlock(&pool->lock);
+            break;
+        }
+        if (pool->queued == 0)
+        {
+            __atomic_fetch_add(&pool->idle, 1, __ATOMIC_RELAXED);
+            pthread_cond_wait(&pool->changed, &pool->lock);
+            __atomic_fetch_sub(&pool->idle, 1, __ATOMIC_RELAXED);
+        }
+        pthread_mutex_unlock(&pool->lock);
+    }
+}
+
+/* Explore the tree from the state at the entry of branch on THREADS
+   threads. Each gets copies of H, the flow and a workspace; the
+   first one to find a smaller cover cancels the others.  */
+static struct bitvec *branch_parallel(struct occ_problem *problem,
+				      struct graph *h_copy, struct graph *occ_g,
+				      const enum color *colors,
+				      const struct bitvec *in_queue,
+				      const vertex *queue, const vertex *qtail)
+{
+    size_t k = problem->occ_size;
+    struct pool pool = {
+        .occ_g       = occ_g,
+        .num_workers = threads,
+        .workers     = calloc(threads, sizeof *pool.workers),
+        .pending     = 1,
+        .queued      = 1,
+    };
+    pthread_mutex_init(&pool.lock, NULL);
+    pthread_cond_init(&pool.changed, NULL);
+    for (unsigned id = 0; id < threads; ++id)
+    {
+        struct worker *worker = &pool.workers[id];
+        worker->pool = &pool;
+        worker->problem = *problem;
+        worker->problem.h = id == 0 ? h_copy : graph_copy(h_copy);
+        worker->problem.flow = flow_make(worker->problem.h);
+        worker->problem.ws = workspace_make(graph_size(worker->problem.h));
+        worker->colors = malloc(k * sizeof *worker->colors);
+        worker->queue = malloc(k * sizeof *worker->queue);
+        worker->in_queue = bitvec_make(k);
+        pthread_mutex_init(&worker->deque.lock, NULL);
+    }
+    deque_push(&pool.workers[0].deque,
+               task_make(problem, problem->flow, colors, in_queue,
+                         queue, queue, qtail, TRY_ALL));
+
+    run_threads(threads, worker_main, &pool);
+
+    for (unsigned id = 0; id < threads; ++id)
+    {
+        struct worker *worker = &pool.workers[id];
+        graph_free(worker->problem.h);
+        flow_free(worker->problem.flow);
+        workspace_free(worker->problem.ws);
+        free(worker->colors);
+        free(worker->queue);
+        bitvec_free(worker->in_queue);
+        free(worker->deque.tasks);
+        pthread_mutex_destroy(&worker->deque.lock);
+    }
+    free(pool.workers);
+    pthread_mutex_destroy(&pool.lock);
+    pthread_cond_destroy(&pool.changed);
+    return pool.result;
+}
+
 struct bitvec *occ_shrink_enum2col(struct occ_problem *problem)
 {
     // Construct the induced subgrapg G[occ].
@@ -248,7 +567,7 @@ struct bitvec *occ_shrink_enum2col(struct occ_problem *problem)
     for (size_t i = 0; i < problem->occ_size; ++i)
 	{
 		vertex v = problem->occ_vertices[i], w;
-		GRAPH_NEIGHBORS_ITER(problem->g, v, w)
+		CSR_VIEW_NEIGHBORS_ITER(problem->g, v, w)
 		{
 		    if (v < w && bitvec_get(problem->occ, w))
 			{
@@ -258,6 +577,11 @@ struct bitvec *occ_shrink_enum2col(struct occ_problem *problem)
 		}
     }
 
+    // The threads need copies of H, which have to be taken while all
+    // vertices are still enabled.
+    bool parallel = threads > 1 && !deterministic;
+    struct graph *h_copy = parallel ? graph_copy(problem->h) : NULL;
+
     for (size_t i = 0; i < problem->occ_size - (problem->last_not_in_occ ? 1 : 0); ++i) {
 		vertex v = problem->occ_vertices[i];
 		graph_vertex_disable(problem->h, v);
@@ -276,8 +600,8 @@ struct bitvec *occ_shrink_enum2col(struct occ_problem *problem)
 		size_t last = problem->occ_size - 1;
 		vertex last_v = problem->occ_vertices[last], j;
 		colors[last] = WHITE;
-		flow_augment_pair(problem->flow, last_v, problem->clones[last_v]);
-		augmentations++;
+		flow_augment_pair(problem->flow, problem->ws, last_v, problem->clones[last_v]);
+		__atomic_fetch_add(&augmentations, 1, __ATOMIC_RELAXED);
 		if (graph_vertex_exists(occ_g, last))
 		{
 		    GRAPH_NEIGHBORS_ITER(occ_g, last, j)
@@ -288,7 +612,9 @@ struct bitvec *occ_shrink_enum2col(struct occ_problem *problem)
 		}
     }
 
-    struct bitvec *new_occ = branch(problem, occ_g, colors, in_queue, queue, qtail);
+    struct bitvec *new_occ = parallel
+        ? branch_parallel(problem, h_copy, occ_g, colors, in_queue, queue, qtail)
+        : branch(problem, NULL, occ_g, colors, in_queue, queue, qtail, TRY_ALL);
 
     graph_free(occ_g);
     return new_occ;
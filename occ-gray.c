@@ -17,17 +17,23 @@
    02110-1301, USA.  */
 
 #include <assert.h>
+#include <pthread.h>
 #include <stdbool.h>
 #include <string.h>
 
 #include "bitvec.h"
 #include "flow.h"
 #include "graph.h"
+#include "hbitvec.h"
 #include "occ.h"
 #include "util.h"
+#include "workspace.h"
 
 extern bool verbose;
 extern unsigned long long augmentations;
+extern bool blocking_flow;
+extern unsigned threads;
+extern bool deterministic;
 
 enum code { SOURCE, DISABLED, TARGET };
 
@@ -41,8 +47,8 @@ static inline void update_vertex(struct occ_problem *problem, size_t i, int g[],
 	    s = v1, t = v2;
 	else
 	    t = v1, s = v2;
-	bitvec_unset(problem->sources, s);
-	bitvec_unset(problem->targets, t);
+	hbitvec_unset(problem->sources, s);
+	hbitvec_unset(problem->targets, t);
 	problem->num_sources--;
 	if (problem->use_graycode)
 	    if (flow_drain_source(problem->flow, s) != t)
@@ -54,8 +60,8 @@ static inline void update_vertex(struct occ_problem *problem, size_t i, int g[],
 	    s = v1, t = v2;
 	else
 	    t = v1, s = v2;
-	bitvec_set(problem->sources, s);
-	bitvec_set(problem->targets, t);
+	hbitvec_set(problem->sources, s);
+	hbitvec_set(problem->targets, t);
 	graph_vertex_enable(problem->h, s);
 	graph_vertex_enable(problem->h, t);
 	problem->num_sources++;
@@ -105,7 +111,179 @@ unsigned long long ipow(unsigned long long a, unsigned long long b) {
 
   * can be ommitted for symmetry
   # can be ommitted if we know last is in Y  */
+/* Augment until every source has its path. Returns false if that is
+   impossible, leaving the search state for flow_last_cut in the
+   workspace.  */
+static bool saturate(struct occ_problem *problem) {
+    if (!problem->use_graycode)
+	flow_clear(problem->flow);
+    while (flow_flow(problem->flow) < problem->num_sources) {
+	// A blocking flow phase counts as one augmentation. It only
+	// pays off when several paths are missing, as after a
+	// flow_clear; a Gray code step usually lacks just one.
+	if (blocking_flow
+	    && problem->num_sources - flow_flow(problem->flow) > 1
+	    ? !flow_augment_blocking(problem->flow, problem->ws,
+				     problem->sources, problem->targets)
+	    : !flow_augment(problem->flow, problem->ws,
+			    problem->sources, problem->targets))
+	    return false;
+	__atomic_fetch_add(&augmentations, 1, __ATOMIC_RELAXED);
+    }
+    return true;
+}
+
+// The smaller cover given by the cut after saturate failed.
+static struct bitvec *cut_occ(struct occ_problem *problem) {
+    if (verbose)
+	fprintf(stderr, "found small cut; ");
+    struct hbitvec *cut = flow_last_cut(problem->flow, problem->ws, problem->sources);
+    struct bitvec *new_occ = bitvec_clone(problem->occ);
+    HBITVEC_ITER(problem->sources, v)
+	if (v < csr_view_size(problem->g))
+	    bitvec_unset(new_occ, v);
+    HBITVEC_ITER(problem->targets, v)
+	if (v < csr_view_size(problem->g))
+	    bitvec_unset(new_occ, v);
+    HBITVEC_ITER(cut, v) {
+	vertex w = v;
+	if (w >= csr_view_size(problem->g))
+	    w = problem->occ_vertices[w - problem->first_clone];
+	bitvec_set(new_occ, w);
+    }
+    assert(occ_is_occ(problem->g, new_occ, problem->ws));
+    hbitvec_free(cut);
+    return new_occ;
+}
+
+static unsigned long long num_gray_codes(const struct occ_problem *problem) {
+    if (problem->last_not_in_occ)
+	return ipow(3, problem->occ_size) / 3; // see comment above
+    else
+	return ipow(3, problem->occ_size) / 2 + 1;
+}
+
+/* Digits and directions of code number N in the sequence generated by
+   occ_shrink_gray: digit i runs up in even blocks of 3^(i+1) codes and
+   down in odd ones.  */
+static void gray_code_at(unsigned long long n, size_t k, int g[], int u[]) {
+    for (size_t i = 0; i < k; i++, n /= 3) {
+	int d = n % 3;
+	bool up = (n / 3) % 2 == 0;
+	g[i] = up ? d : 2 - d;
+	u[i] = up ? +1 : -1;
+    }
+}
+
+struct gray_pool {
+    const struct occ_problem *problem;
+    const struct graph *h;		// H with all vertices enabled
+    unsigned long long num_codes, chunk_size;
+    unsigned long long next_chunk;	// atomic
+    bool cancel;			// atomic
+    pthread_mutex_t lock;
+    struct bitvec *result;
+};
+
+/* Claim chunks of consecutive codes and walk each like the sequential
+   loop does, on private copies of H, the flow and the terminals.  */
+static void gray_worker(void *arg, unsigned id) {
+    (void) id;
+    struct gray_pool *pool = arg;
+    size_t k = pool->problem->occ_size;
+    struct occ_problem problem = *pool->problem;
+    problem.h = graph_copy(pool->h);
+    problem.flow = flow_make(problem.h);
+    problem.ws = workspace_make(graph_size(problem.h));
+    problem.sources = hbitvec_make(graph_size(problem.h));
+    problem.targets = hbitvec_make(graph_size(problem.h));
+    problem.num_sources = 0;
+
+    int u[k], g[k], start[k];
+    for (size_t i = 0; i < k; i++) {
+	g[i] = DISABLED;
+	graph_vertex_disable(problem.h, problem.occ_vertices[i]);
+	graph_vertex_disable(problem.h, problem.first_clone + i);
+    }
+    struct bitvec *new_occ = NULL;
+    while (!new_occ) {
+	unsigned long long n = __atomic_fetch_add(&pool->next_chunk, 1, __ATOMIC_RELAXED)
+	    * pool->chunk_size;
+	if (n >= pool->num_codes)
+	    break;
+	unsigned long long end = n + pool->chunk_size;
+	if (end > pool->num_codes)
+	    end = pool->num_codes;
+	// Draining paths one digit at a time, as update_vertex does, is
+	// only valid if all other sources still have theirs; when
+	// jumping to the start of a chunk, rebuild the flow instead.
+	gray_code_at(n, k, start, u);
+	flow_clear(problem.flow);
+	problem.use_graycode = false;
+	for (size_t i = 0; i < k; i++)
+	    if (g[i] != start[i])
+		update_vertex(&problem, i, g, start[i]);
+	problem.use_graycode = pool->problem->use_graycode;
+
+	while (!__atomic_load_n(&pool->cancel, __ATOMIC_RELAXED) && !*problem.interrupt) {
+	    if (!saturate(&problem)) {
+		new_occ = cut_occ(&problem);
+		break;
+	    }
+	    if (++n == end)
+		break;
+	    size_t i = 0;
+	    int j = g[0] + u[0];
+	    while (j >= 3 || j < 0) {
+		u[i] = -u[i];
+		i++;
+		j = g[i] + u[i];
+	    }
+	    update_vertex(&problem, i, g, j);
+	}
+	if (__atomic_load_n(&pool->cancel, __ATOMIC_RELAXED) || *problem.interrupt)
+	    break;
+    }
+
+    if (new_occ) {
+	pthread_mutex_lock(&pool->lock);
+	if (!pool->result) {
+	    pool->result = new_occ;
+	    __atomic_store_n(&pool->cancel, true, __ATOMIC_RELAXED);
+	} else {
+	    bitvec_free(new_occ);
+	}
+	pthread_mutex_unlock(&pool->lock);
+    }
+    graph_free(problem.h);
+    flow_free(problem.flow);
+    workspace_free(problem.ws);
+    hbitvec_free(problem.sources);
+    hbitvec_free(problem.targets);
+}
+
+/* Split the codes into chunks, several per thread so that threads
+   finishing early can take more. Every chunk starts from its first
+   code computed directly; the first cut found cancels the rest.  */
+static struct bitvec *occ_shrink_gray_parallel(struct occ_problem *problem) {
+    struct gray_pool pool = {
+	.problem = problem,
+	.h = problem->h,
+	.num_codes = num_gray_codes(problem),
+    };
+    pool.chunk_size = pool.num_codes / (16 * threads);
+    if (pool.chunk_size == 0)
+	pool.chunk_size = 1;
+    pthread_mutex_init(&pool.lock, NULL);
+    run_threads(threads, gray_worker, &pool);
+    pthread_mutex_destroy(&pool.lock);
+    return pool.result;
+}
+
 struct bitvec *occ_shrink_gray(struct occ_problem *problem) {
+    if (threads > 1 && !deterministic)
+	return occ_shrink_gray_parallel(problem);
+
     int u[problem->occ_size];	// +1 or -1, current Gray change direction
     int g[problem->occ_size];
     for (size_t i = 0; i < problem->occ_size; i++) {
@@ -114,36 +292,11 @@ struct bitvec *occ_shrink_gray(struct occ_problem *problem) {
 	update_vertex(problem, i, g, SOURCE);
     }
 
-    unsigned long long num_codes;
-    if (problem->last_not_in_occ)
-	num_codes = ipow(3, problem->occ_size) / 3; // see comment above
-    else
-	num_codes = ipow(3, problem->occ_size) / 2 + 1;
+    unsigned long long num_codes = num_gray_codes(problem);
 
     while (true) {
-	if (!problem->use_graycode)
-	    flow_clear(problem->flow);
-	while (flow_flow(problem->flow) < problem->num_sources
-               && flow_augment(problem->flow, problem->sources, problem->targets))
-            augmentations++;
-
-	if (flow_flow(problem->flow) < problem->num_sources) {
-	    if (verbose)
-		fprintf(stderr, "found small cut; ");
-            struct bitvec *cut = flow_vertex_cut(problem->flow, problem->sources);
-	    struct bitvec *new_occ = bitvec_make(problem->g->size);
-	    bitvec_copy(new_occ, problem->occ);
-	    bitvec_setminus(new_occ, problem->sources);
-	    bitvec_setminus(new_occ, problem->targets);
-	    BITVEC_ITER(cut, v) {
-		if (v >= problem->g->size)
-		    v = problem->occ_vertices[v - problem->first_clone];
-		bitvec_set(new_occ, v);
-	    }
-	    assert(occ_is_occ(problem->g, new_occ));
-	    bitvec_free(cut);
-	    return new_occ;	    
-        }
+	if (!saturate(problem))
+	    return cut_occ(problem);
 	if (--num_codes == 0)
 	    break;
 
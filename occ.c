@@ -22,27 +22,33 @@
 #include <string.h>
 
 #include "bitvec.h"
+#include "csr.h"
 #include "flow.h"
 #include "graph.h"
+#include "hbitvec.h"
 #include "occ.h"
+#include "unionfind.h"
 #include "util.h"
+#include "workspace.h"
+
+#define NULL_VERTEX ((vertex) -1)
 
 extern bool verbose;
 extern unsigned long long augmentations;
 
 static struct graph *occ_construct_h(struct occ_problem *problem)
 {
-    size_t size = graph_size(problem->g);
+    size_t size = csr_view_size(problem->g);
     assert (bitvec_size(problem->occ) == size);
     problem->occ_vertices = calloc(sizeof *problem->occ_vertices, problem->occ_size);
     problem->clones = calloc(sizeof *problem->clones, size);
-    ALLOCA_BITVEC(coloring, size + problem->occ_size);
-    ALLOCA_BITVEC(not_occ, size);
-    bitvec_copy(not_occ, problem->occ);
-    bitvec_invert(not_occ);
-    problem->h = graph_subgraph(problem->g, not_occ);
-    graph_two_coloring(problem->h, coloring);
-    problem->h = graph_grow(problem->h, size + problem->occ_size);
+    struct bitvec *coloring = problem->ws->colors;
+    bitvec_clear(coloring);
+    struct bitvec *not_occ = bitvec_make(size);
+    bitvec_difference(not_occ, problem->g->mask, problem->occ);
+    csr_two_coloring(problem->g, problem->occ, coloring, problem->ws);
+    problem->h = graph_from_csr(problem->g->g, not_occ, size + problem->occ_size);
+    bitvec_free(not_occ);
     size_t clone = 0;
     BITVEC_ITER(problem->occ, v)
     {
@@ -50,7 +56,7 @@ static struct graph *occ_construct_h(struct occ_problem *problem)
 	    problem->clones[v] = problem->first_clone + clone;
 
 	    vertex w;
-	    GRAPH_NEIGHBORS_ITER(problem->g, v, w)
+	    CSR_VIEW_NEIGHBORS_ITER(problem->g, v, w)
         {
 	        if (bitvec_get(problem->occ, w) && v > w)
             {
@@ -69,28 +75,287 @@ static struct graph *occ_construct_h(struct occ_problem *problem)
 	    ++clone;
     }
 
-    assert(graph_is_bipartite(problem->h));
+    assert(graph_is_bipartite(problem->h, problem->ws));
     return problem->h;
 }
 
-bool occ_is_occ(const struct graph *g, const struct bitvec *occ)
+/* Connect V, which has just entered G[mask] - occ, to its neighbors
+   there.  */
+static void state_insert(struct occ_state *state, const struct csr_view *g,
+			 vertex v)
+{
+    graph_vertex_add(state->h, v, csr_degree(g->g, v));
+    vertex w;
+    CSR_VIEW_NEIGHBORS_ITER(g, v, w)
+    {
+        if (w != v && graph_vertex_exists(state->h, w))
+        {
+            graph_connect(state->h, v, w);
+        }
+    }
+}
+
+static void state_remove(struct occ_state *state, vertex v)
+{
+    struct graph *h = state->h;
+    while (h->vertices[v]->deg > 0)
+    {
+        graph_disconnect(h, v, h->vertices[v]->neighbors[0]);
+    }
+    graph_vertex_disable(h, v);
+}
+
+static bool state_relink(struct occ_state *state)
+{
+    unionfind_reset(state->uf);
+    vertex v, w;
+    GRAPH_ITER_EDGES(state->h, v, w)
+    {
+        if (!unionfind_link(state->uf, v, w))
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+struct occ_state *occ_state_make(const struct csr_view *g,
+				 const struct bitvec *occ)
+{
+    size_t size = csr_view_size(g);
+    struct occ_state *state = calloc(1, sizeof *state);
+    state->size = size;
+    struct bitvec *not_occ = bitvec_make(size);
+    bitvec_difference(not_occ, g->mask, occ);
+    state->h = graph_from_csr(g->g, not_occ, size);
+    bitvec_free(not_occ);
+    state->uf = unionfind_make(size);
+    state_relink(state);
+    state->clones = calloc(size, sizeof *state->clones);
+    state->saved_deg = malloc(size * sizeof *state->saved_deg);
+    for (size_t v = 0; v < size; ++v)
+    {
+        state->saved_deg[v] = NULL_VERTEX;
+    }
+    return state;
+}
+
+void occ_state_free(struct occ_state *state)
+{
+    graph_free(state->h);
+    unionfind_free(state->uf);
+    if (state->flow)
+    {
+        flow_free(state->flow);
+        hbitvec_free(state->sources);
+        hbitvec_free(state->targets);
+    }
+    free(state->clones);
+    free(state->occ_vertices);
+    free(state->saved_deg);
+    free(state->touched);
+    free(state);
+}
+
+bool occ_state_add(struct occ_state *state, const struct csr_view *g,
+		   const struct bitvec *occ, vertex v)
+{
+    vertex w;
+    unionfind_begin(state->uf);
+    CSR_VIEW_NEIGHBORS_ITER(g, v, w)
+    {
+        if (w == v || (!bitvec_get(occ, w) && !unionfind_fits(state->uf, w)))
+        {
+            return false;
+        }
+    }
+    CSR_VIEW_NEIGHBORS_ITER(g, v, w)
+    {
+        if (!bitvec_get(occ, w))
+        {
+            unionfind_link(state->uf, v, w);
+        }
+    }
+    state_insert(state, g, v);
+    return true;
+}
+
+/* Like occ_construct_h, but add the occ vertices and their clones to
+   the H kept in STATE, coloring by the union-find. Only the neighbor
+   lists of G[mask] - occ that get an edge appended are saved, so
+   occ_detach can cut them back.  */
+static void occ_attach(struct occ_problem *problem, struct occ_state *state)
+{
+    size_t size = state->size, k = problem->occ_size;
+    if (k > state->occ_capacity)
+    {
+        state->occ_capacity = 2 * k;
+        state->occ_vertices = realloc(state->occ_vertices,
+				      state->occ_capacity * sizeof *state->occ_vertices);
+    }
+    if (size + k > graph_size(state->h))
+    {
+        state->h = graph_grow(state->h, size + k);
+    }
+    struct graph *h = state->h;
+
+    size_t clone = 0;
+    BITVEC_ITER(problem->occ, v)
+    {
+        state->occ_vertices[clone] = v;
+        state->clones[v] = size + clone;
+        graph_vertex_add(h, v, csr_degree(problem->g->g, v));
+        graph_vertex_add(h, size + clone, 0);
+        ++clone;
+    }
+
+    for (size_t i = 0; i < k; ++i)
+    {
+        vertex v = state->occ_vertices[i], w;
+        CSR_VIEW_NEIGHBORS_ITER(problem->g, v, w)
+        {
+            bool color = false;
+            if (bitvec_get(problem->occ, w))
+            {
+                if (v > w)
+                {
+                    continue;
+                }
+            }
+            else
+            {
+                if (state->saved_deg[w] == NULL_VERTEX)
+                {
+                    if (state->num_touched == state->touched_capacity)
+                    {
+                        state->touched_capacity = 2 * state->touched_capacity + 16;
+                        state->touched = realloc(state->touched,
+						 state->touched_capacity * sizeof *state->touched);
+                    }
+                    state->touched[state->num_touched++] = w;
+                    state->saved_deg[w] = h->vertices[w]->deg;
+                }
+                unionfind_find(state->uf, w, &color);
+            }
+            graph_connect(h, color ? v : state->clones[v], w);
+        }
+    }
+
+    size_t h_size = graph_size(h);
+    if (state->flow && state->flow_size != h_size)
+    {
+        flow_free(state->flow);
+        hbitvec_free(state->sources);
+        hbitvec_free(state->targets);
+        state->flow = NULL;
+    }
+    if (state->flow)
+    {
+        flow_clear(state->flow);
+    }
+    else
+    {
+        state->flow = flow_make(h);
+        state->flow_size = h_size;
+        state->sources = hbitvec_make(h_size);
+        state->targets = hbitvec_make(h_size);
+    }
+
+    problem->h = h;
+    problem->flow = state->flow;
+    problem->sources = state->sources;
+    problem->targets = state->targets;
+    problem->occ_vertices = state->occ_vertices;
+    problem->clones = state->clones;
+}
+
+/* Take the occ vertices and clones off H again, whatever the engine
+   left enabled, and cut the saved neighbor lists back.  */
+static void occ_detach(struct occ_problem *problem, struct occ_state *state)
+{
+    struct graph *h = state->h;
+    for (size_t i = 0; i < problem->occ_size; ++i)
+    {
+        vertex v = state->occ_vertices[i], c = state->clones[v];
+        graph_vertex_add(h, v, 0);
+        graph_vertex_disable(h, v);
+        graph_vertex_add(h, c, 0);
+        graph_vertex_disable(h, c);
+        hbitvec_unset(state->sources, v);
+        hbitvec_unset(state->targets, v);
+        hbitvec_unset(state->sources, c);
+        hbitvec_unset(state->targets, c);
+        state->clones[v] = 0;
+    }
+    for (size_t i = 0; i < state->num_touched; ++i)
+    {
+        vertex w = state->touched[i];
+        h->vertices[w]->deg = state->saved_deg[w];
+        state->saved_deg[w] = NULL_VERTEX;
+    }
+    state->num_touched = 0;
+}
+
+/* Move STATE from OCC to the smaller cover NEW_OCC. Vertices that
+   enter the cover may split components, which the union-find cannot
+   undo, so then it is rebuilt.  */
+static void occ_state_update(struct occ_state *state, const struct csr_view *g,
+			     const struct bitvec *occ, const struct bitvec *new_occ)
+{
+    bool entered = false;
+    BITVEC_ITER(new_occ, v)
+    {
+        if (!bitvec_get(occ, v))
+        {
+            state_remove(state, v);
+            entered = true;
+        }
+    }
+    BITVEC_ITER(occ, v)
+    {
+        if (!bitvec_get(new_occ, v))
+        {
+            state_insert(state, g, v);
+        }
+    }
+
+    if (entered)
+    {
+        bool bipartite = state_relink(state);
+        assert(bipartite);
+        (void) bipartite;
+        return;
+    }
+    BITVEC_ITER(occ, v)
+    {
+        if (!bitvec_get(new_occ, v))
+        {
+            vertex w;
+            GRAPH_NEIGHBORS_ITER(state->h, v, w)
+            {
+                bool linked = unionfind_link(state->uf, v, w);
+                assert(linked);
+                (void) linked;
+            }
+        }
+    }
+}
+
+bool occ_is_occ(const struct csr_view *g, const struct bitvec *occ,
+		struct workspace *ws)
 {
-    assert(g->size == occ->num_bits);
-    ALLOCA_U_BITVEC(not_occ, g->size);
-    bitvec_copy(not_occ, occ);
-    bitvec_invert(not_occ);
-    struct graph *g2 = graph_subgraph(g, not_occ);
-    bool occ_is_occ = graph_is_bipartite(g2);
-    graph_free(g2);
-    return occ_is_occ;
+    assert(csr_view_size(g) == occ->num_bits);
+    return csr_two_coloring(g, occ, ws->colors, ws);
 }
 
-struct bitvec *occ_shrink(const struct graph *g, const struct bitvec *occ,
-			  bool enum2col, bool use_graycode,
-			  bool last_not_in_occ, volatile sig_atomic_t *interrupt)
+struct bitvec *occ_shrink(const struct csr_view *g, const struct bitvec *occ,
+			  struct workspace *ws, bool enum2col, bool use_graycode,
+			  bool last_not_in_occ, volatile sig_atomic_t *interrupt,
+			  struct occ_state *state)
 {
-    assert(occ_is_occ(g, occ));
-    assert(graph_size(g) == bitvec_size(occ));
+    // With a state the check would cost more than the whole step.
+    assert(state || occ_is_occ(g, occ, ws));
+    assert(csr_view_size(g) == bitvec_size(occ));
     size_t occ_size = bitvec_count(occ);
     if (occ_size == 0 || (last_not_in_occ && occ_size == 1))
     {
@@ -101,7 +366,7 @@ struct bitvec *occ_shrink(const struct graph *g, const struct bitvec *occ,
     struct bitvec *new_occ = bitvec_clone(occ);
     BITVEC_ITER(occ, v) {
 	bitvec_unset(new_occ, v);
-	if (occ_is_occ(g, new_occ))
+	if (state ? occ_state_add(state, g, new_occ, v) : occ_is_occ(g, new_occ, ws))
     {
 	    if (verbose)
         {
@@ -115,30 +380,40 @@ struct bitvec *occ_shrink(const struct graph *g, const struct bitvec *occ,
 
     }
 
-    if (bitvec_count(new_occ) < bitvec_count(occ))
+    if (bitvec_count_difference(occ, new_occ) > 0)
     {
 	    return new_occ;
     }
 
     bitvec_free(new_occ);
 
-    size_t h_size = g->size + occ_size;
     struct occ_problem *problem = &(struct occ_problem)
     {
     	.g               = g,
     	.occ             = occ,
-    	.sources	 = bitvec_make(h_size),
-    	.targets	 = bitvec_make(h_size),
+    	.ws		 = ws,
     	.num_sources     = 0,
     	.use_graycode    = use_graycode,
     	.last_not_in_occ = last_not_in_occ,
     	.occ_size        = occ_size,
-    	.first_clone	 = graph_size(g),
+    	.first_clone	 = csr_view_size(g),
         .interrupt       = interrupt
     };
 
-    occ_construct_h(problem);
-    problem->flow = flow_make(problem->h);
+    if (state)
+    {
+        occ_attach(problem, state);
+        workspace_reserve(ws, graph_size(problem->h));
+    }
+    else
+    {
+        size_t h_size = csr_view_size(g) + occ_size;
+        workspace_reserve(ws, h_size);
+        problem->sources = hbitvec_make(h_size);
+        problem->targets = hbitvec_make(h_size);
+        occ_construct_h(problem);
+        problem->flow = flow_make(problem->h);
+    }
 
     if (enum2col)
     {
@@ -155,9 +430,21 @@ struct bitvec *occ_shrink(const struct graph *g, const struct bitvec *occ,
         (unsigned long long) augmentations);
     }
 
+    if (state)
+    {
+        occ_detach(problem, state);
+        if (new_occ)
+        {
+            occ_state_update(state, g, occ, new_occ);
+        }
+        return new_occ;
+    }
+
     graph_free(problem->h);
-    bitvec_free(problem->sources);
-    bitvec_free(problem->targets);
+    free(problem->occ_vertices);
+    free(problem->clones);
+    hbitvec_free(problem->sources);
+    hbitvec_free(problem->targets);
     flow_free(problem->flow);
 
     return new_occ;
@@ -21,20 +21,25 @@
 
 #include <stdbool.h>
 #include <signal.h>
+#include "csr.h"
 #include "graph.h"
 
 struct bitvec;
 struct flow;
+struct hbitvec;
+struct unionfind;
+struct workspace;
 
 struct occ_problem
 {
-    const struct graph *g;	// input graph
+    const struct csr_view *g;	// input graph
     struct graph *h;		// G' as described by Reed et al.
     const struct bitvec *occ;	// known odd cycle cover for g
     vertex *occ_vertices;	// array of the k vertices in occ
     vertex *clones;		// clones[v] contains the clone of [v] or 0
-    struct bitvec *sources, *targets; // for the flow
+    struct hbitvec *sources, *targets; // for the flow
     struct flow *flow;
+    struct workspace *ws;	// scratch for flow and coloring searches
     size_t num_sources;
     bool use_graycode;
     bool last_not_in_occ;
@@ -42,9 +47,41 @@ struct occ_problem
     volatile sig_atomic_t *interrupt;
 };
 
-bool occ_is_occ(const struct graph *g, const struct bitvec *occ);
-struct bitvec *occ_shrink(const struct graph *g, const struct bitvec *occ,
-    bool enum2col, bool use_graycode, bool last_not_in_occ, volatile sig_atomic_t *interrupt);
+/* What occ_shrink needs across the steps of one compression pass,
+   kept up to date for the cover of the last call instead of being
+   rebuilt each time. Between calls, H holds just G[mask] - occ, and UF
+   two-colors it; the occ vertices and their clones are attached for
+   the duration of a call and taken off again afterwards.  */
+struct occ_state
+{
+    size_t size;		// vertices of G
+    struct graph *h;
+    struct unionfind *uf;
+    struct flow *flow;		// made for h at flow_size vertices
+    size_t flow_size;
+    struct hbitvec *sources, *targets;
+    vertex *clones;		// all 0 between calls
+    vertex *occ_vertices;
+    size_t occ_capacity;
+    vertex *saved_deg;		// degrees in G[mask] - occ while attached
+    vertex *touched;		// vertices whose saved_deg is set
+    size_t num_touched, touched_capacity;
+};
+
+struct occ_state *occ_state_make(const struct csr_view *g,
+				 const struct bitvec *occ);
+void occ_state_free(struct occ_state *state);
+/* V has just been added to the mask of G. If G[mask] - occ stays
+   bipartite, record V and return true; otherwise leave STATE as it
+   was and return false.  */
+bool occ_state_add(struct occ_state *state, const struct csr_view *g,
+		   const struct bitvec *occ, vertex v);
+
+bool occ_is_occ(const struct csr_view *g, const struct bitvec *occ,
+		struct workspace *ws);
+struct bitvec *occ_shrink(const struct csr_view *g, const struct bitvec *occ,
+    struct workspace *ws, bool enum2col, bool use_graycode, bool last_not_in_occ, volatile sig_atomic_t *interrupt,
+    struct occ_state *state);
 struct bitvec *occ_heuristic(const struct graph *g);
 struct bitvec *occ_shrink_gray(struct occ_problem *problem);
 struct bitvec *occ_shrink_enum2col(struct occ_problem *problem);
@@ -0,0 +1,81 @@
+/* occ -- find minimum odd cycle covers (Graph Bipartization)
+   Copyright (C) 2006 Falk Hueffner
+
+   This program is free software; you can redistribute it and/or
+   modify it under the terms of the GNU General Public License as
+   published by the Free Software Foundation; either version 2 of
+   the License, or (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with GCC; see the file COPYING.  If not, write to the Free
+   Software Foundation, 51 Franklin Street, Fifth Floor, Boston, MA
+   02110-1301, USA.  */
+
+#define _GNU_SOURCE
+
+#include "perf.h"
+
+#ifdef __linux__
+
+#include <linux/perf_event.h>
+#include <string.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+int perf_cache_misses_start(void)
+{
+    struct perf_event_attr attr;
+    memset(&attr, 0, sizeof attr);
+    attr.size = sizeof attr;
+    attr.type = PERF_TYPE_HARDWARE;
+    attr.config = PERF_COUNT_HW_CACHE_MISSES;
+    attr.disabled = 1;
+    attr.exclude_kernel = 1;
+    attr.exclude_hv = 1;
+
+    int fd = syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0);
+    if (fd < 0)
+    {
+        return -1;
+    }
+    ioctl(fd, PERF_EVENT_IOC_RESET, 0);
+    ioctl(fd, PERF_EVENT_IOC_ENABLE, 0);
+    return fd;
+}
+
+long long perf_cache_misses_stop(int handle)
+{
+    if (handle < 0)
+    {
+        return -1;
+    }
+    ioctl(handle, PERF_EVENT_IOC_DISABLE, 0);
+    long long count;
+    if (read(handle, &count, sizeof count) != sizeof count)
+    {
+        count = -1;
+    }
+    close(handle);
+    return count;
+}
+
+#else
+
+int perf_cache_misses_start(void)
+{
+    return -1;
+}
+
+long long perf_cache_misses_stop(int handle)
+{
+    (void) handle;
+    return -1;
+}
+
+#endif
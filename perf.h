@@ -0,0 +1,33 @@
+/* occ -- find minimum odd cycle covers (Graph Bipartization)
+   Copyright (C) 2006 Falk Hueffner
+
+   This program is free software; you can redistribute it and/or
+   modify it under the terms of the GNU General Public License as
+   published by the Free Software Foundation; either version 2 of
+   the License, or (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with GCC; see the file COPYING.  If not, write to the Free
+   Software Foundation, 51 Franklin Street, Fifth Floor, Boston, MA
+   02110-1301, USA.  */
+
+#ifndef PERF_H
+#define PERF_H
+
+/* Hardware cache miss counter for the calling thread, for the verbose
+   statistics. Only available on Linux, and only where the kernel lets
+   unprivileged processes use performance counters.  */
+
+/* Start counting. Returns a handle, or -1 if there is no counter.  */
+int perf_cache_misses_start(void);
+
+/* Return the number of cache misses since perf_cache_misses_start and
+   release HANDLE, or -1 if HANDLE is -1 or the counter failed.  */
+long long perf_cache_misses_stop(int handle);
+
+#endif // PERF_H
@@ -0,0 +1,461 @@
+/* occ -- find minimum odd cycle covers (Graph Bipartization)
+   Copyright (C) 2006 Falk Hueffner
+
+   This program is free software; you can redistribute it and/or
+   modify it under the terms of the GNU General Public License as
+   published by the Free Software Foundation; either version 2 of
+   the License, or (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with GCC; see the file COPYING.  If not, write to the Free
+   Software Foundation, 51 Franklin Street, Fifth Floor, Boston, MA
+   02110-1301, USA.  */
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "bitvec.h"
+#include "csr.h"
+#include "graph.h"
+#include "reduce.h"
+
+#define NULL_VERTEX ((vertex) -1)
+
+/* The rules work on a mutable copy H of the input graph. Deleted
+   vertices are disabled in H and recorded in the reversal log.
+
+   Degree-2 paths are folded two inner vertices at a time: the path
+   u - v - a - w becomes the edge u - w, which has the same length
+   modulo 2, so the kernel stays an ordinary graph and the solvers need
+   not know about edge parities. Some optimal cover avoids v and a,
+   since u hits every odd cycle through them.  */
+struct state {
+    struct graph *h;
+    struct reduction *r;
+    size_t capacity;		// of r->steps
+};
+
+static void log_step(struct state *s, enum reduce_rule rule, vertex v)
+{
+    struct reduction *r = s->r;
+    if (r->num_steps == s->capacity)
+    {
+        s->capacity = s->capacity ? 2 * s->capacity : 64;
+        r->steps = realloc(r->steps, s->capacity * sizeof *r->steps);
+    }
+    r->steps[r->num_steps].rule = rule;
+    r->steps[r->num_steps].v = v;
+    r->num_steps++;
+}
+
+static inline size_t degree(const struct graph *h, vertex v)
+{
+    return h->vertices[v]->deg;
+}
+
+// Remove W from the neighbors of V, but not V from those of W.
+static void remove_neighbor(struct graph *h, vertex v, vertex w)
+{
+    struct vertex *p = h->vertices[v];
+    for (size_t i = 0; i < p->deg; ++i)
+    {
+        if (p->neighbors[i] == w)
+        {
+            p->neighbors[i] = p->neighbors[--p->deg];
+            return;
+        }
+    }
+    assert(!"neighbor not found");
+}
+
+static void delete_vertex(struct state *s, vertex v, enum reduce_rule rule)
+{
+    struct graph *h = s->h;
+    vertex w;
+    GRAPH_NEIGHBORS_ITER(h, v, w)
+    {
+        remove_neighbor(h, w, v);
+    }
+    h->vertices[v]->deg = 0;
+    graph_vertex_disable(h, v);
+    log_step(s, rule, v);
+}
+
+static bool adjacent(const struct graph *h, vertex u, vertex w)
+{
+    if (degree(h, u) > degree(h, w))
+    {
+        vertex t = u;
+        u = w;
+        w = t;
+    }
+    vertex x;
+    GRAPH_NEIGHBORS_ITER(h, u, x)
+    {
+        if (x == w)
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+/* Copy G into H, dropping self-loops and merging parallel edges. The
+   vertices with self-loops are deleted into the cover afterwards.  */
+static void load(struct state *s, const struct csr *g)
+{
+    size_t size = csr_size(g);
+    struct bitvec *all = bitvec_make(size);
+    bitvec_fill(all);
+    struct graph *h = s->h = graph_from_csr(g, all, size);
+    bitvec_free(all);
+
+    struct bitvec *loops = bitvec_make(size);
+    vertex *last = malloc((size ? size : 1) * sizeof *last);
+    for (size_t v = 0; v < size; ++v)
+    {
+        last[v] = NULL_VERTEX;
+    }
+    size_t duplicates = 0;
+    for (size_t v = 0; v < size; ++v)
+    {
+        struct vertex *p = h->vertices[v];
+        size_t deg = 0;
+        for (size_t i = 0; i < p->deg; ++i)
+        {
+            vertex w = p->neighbors[i];
+            if (w == v)
+            {
+                bitvec_set(loops, v);
+            }
+            else if (last[w] == v)
+            {
+                duplicates++;
+            }
+            else
+            {
+                last[w] = v;
+                p->neighbors[deg++] = w;
+            }
+        }
+        p->deg = deg;
+    }
+    free(last);
+    s->r->num_merged = duplicates / 2;
+
+    BITVEC_ITER(loops, v)
+    {
+        delete_vertex(s, v, REDUCE_SELF_LOOP);
+    }
+    bitvec_free(loops);
+}
+
+// Delete vertices of degree at most 1, and those that drop to it.
+static size_t remove_low_degree(struct state *s)
+{
+    struct graph *h = s->h;
+    size_t size = graph_size(h), removed = 0;
+    vertex *stack = malloc((size ? size : 1) * sizeof *stack);
+    bool *queued = calloc(size ? size : 1, sizeof *queued);
+    size_t top = 0;
+
+    for (size_t v = 0; v < size; ++v)
+    {
+        if (graph_vertex_exists(h, v) && degree(h, v) <= 1)
+        {
+            stack[top++] = v;
+            queued[v] = true;
+        }
+    }
+    while (top > 0)
+    {
+        vertex v = stack[--top];
+        queued[v] = false;
+        vertex w = degree(h, v) == 1 ? h->vertices[v]->neighbors[0] : NULL_VERTEX;
+        delete_vertex(s, v, REDUCE_LOW_DEGREE);
+        removed++;
+        if (w != NULL_VERTEX && degree(h, w) <= 1 && !queued[w])
+        {
+            stack[top++] = w;
+            queued[w] = true;
+        }
+    }
+
+    free(stack);
+    free(queued);
+    return removed;
+}
+
+// Fold adjacent pairs of degree-2 vertices (see above).
+static size_t fold_paths(struct state *s)
+{
+    struct graph *h = s->h;
+    size_t folded = 0;
+    for (size_t v = 0; v < graph_size(h); ++v)
+    {
+        if (!graph_vertex_exists(h, v) || degree(h, v) != 2)
+        {
+            continue;
+        }
+        for (int i = 0; i < 2; ++i)
+        {
+            vertex a = h->vertices[v]->neighbors[i];
+            if (degree(h, a) != 2)
+            {
+                continue;
+            }
+            vertex u = h->vertices[v]->neighbors[1 - i];
+            vertex w = h->vertices[a]->neighbors[0];
+            if (w == v)
+            {
+                w = h->vertices[a]->neighbors[1];
+            }
+            delete_vertex(s, v, REDUCE_FOLD);
+            delete_vertex(s, a, REDUCE_FOLD);
+            if (u == w)
+            {
+                // A triangle hanging off u, which is now a self-loop.
+                delete_vertex(s, u, REDUCE_SELF_LOOP);
+            }
+            else if (adjacent(h, u, w))
+            {
+                s->r->num_merged++;
+            }
+            else
+            {
+                graph_connect(h, u, w);
+            }
+            folded += 2;
+            break;
+        }
+    }
+    return folded;
+}
+
+/* Delete the edges of all bipartite blocks (biconnected components),
+   and the vertices left without edges. Every odd cycle lies inside a
+   single block, so this keeps all of them. The blocks come from an
+   iterative Tarjan search; a block is bipartite exactly if none of its
+   back edges closes a cycle of odd length in the search tree.  */
+static size_t remove_bipartite_blocks(struct state *s)
+{
+    struct graph *h = s->h;
+    size_t size = graph_size(h), m = graph_num_edges(h), n = size ? size : 1;
+    size_t *disc = calloc(n, sizeof *disc);
+    size_t *low = malloc(n * sizeof *low);
+    size_t *pos = malloc(n * sizeof *pos);
+    size_t *first_edge = malloc(n * sizeof *first_edge);
+    vertex *parent = malloc(n * sizeof *parent);
+    bool *odd_depth = malloc(n * sizeof *odd_depth);
+    vertex *stack = malloc(n * sizeof *stack);
+    vertex (*edges)[2] = malloc((m ? m : 1) * sizeof *edges);
+    vertex (*doomed)[2] = malloc((m ? m : 1) * sizeof *doomed);
+    size_t time = 0, num_edges = 0, num_doomed = 0;
+
+    for (size_t root = 0; root < size; ++root)
+    {
+        if (!graph_vertex_exists(h, root) || disc[root] != 0)
+        {
+            continue;
+        }
+        size_t top = 0;
+        disc[root] = low[root] = ++time;
+        pos[root] = 0;
+        parent[root] = NULL_VERTEX;
+        odd_depth[root] = false;
+        stack[top++] = root;
+        while (top > 0)
+        {
+            vertex v = stack[top - 1];
+            if (pos[v] < degree(h, v))
+            {
+                vertex w = h->vertices[v]->neighbors[pos[v]++];
+                if (disc[w] == 0)
+                {
+                    disc[w] = low[w] = ++time;
+                    pos[w] = 0;
+                    parent[w] = v;
+                    odd_depth[w] = !odd_depth[v];
+                    first_edge[w] = num_edges;
+                    edges[num_edges][0] = v;
+                    edges[num_edges][1] = w;
+                    num_edges++;
+                    stack[top++] = w;
+                }
+                else if (w != parent[v] && disc[w] < disc[v])
+                {
+                    edges[num_edges][0] = v;
+                    edges[num_edges][1] = w;
+                    num_edges++;
+                    if (disc[w] < low[v])
+                    {
+                        low[v] = disc[w];
+                    }
+                }
+                continue;
+            }
+
+            top--;
+            vertex p = parent[v];
+            if (p == NULL_VERTEX)
+            {
+                continue;
+            }
+            if (low[v] < low[p])
+            {
+                low[p] = low[v];
+            }
+            if (low[v] >= disc[p])
+            {
+                // The edges pushed since p - v form a block.
+                bool odd = false;
+                for (size_t e = first_edge[v]; e < num_edges; ++e)
+                {
+                    odd |= odd_depth[edges[e][0]] == odd_depth[edges[e][1]];
+                }
+                if (!odd)
+                {
+                    memcpy(doomed + num_doomed, edges + first_edge[v],
+                           (num_edges - first_edge[v]) * sizeof *edges);
+                    num_doomed += num_edges - first_edge[v];
+                }
+                num_edges = first_edge[v];
+            }
+        }
+    }
+
+    for (size_t e = 0; e < num_doomed; ++e)
+    {
+        graph_disconnect(h, doomed[e][0], doomed[e][1]);
+    }
+    for (size_t e = 0; e < num_doomed; ++e)
+    {
+        for (int i = 0; i < 2; ++i)
+        {
+            vertex v = doomed[e][i];
+            if (graph_vertex_exists(h, v) && degree(h, v) == 0)
+            {
+                delete_vertex(s, v, REDUCE_BIPARTITE_BLOCK);
+            }
+        }
+    }
+
+    free(disc);
+    free(low);
+    free(pos);
+    free(first_edge);
+    free(parent);
+    free(odd_depth);
+    free(stack);
+    free(edges);
+    free(doomed);
+    return num_doomed;
+}
+
+// Renumber the vertices left in H consecutively and build the kernel.
+static void compact(struct state *s)
+{
+    struct graph *h = s->h;
+    struct reduction *r = s->r;
+    size_t size = graph_size(h), k = 0, m = graph_num_edges(h);
+    vertex *kernel_of = malloc((size ? size : 1) * sizeof *kernel_of);
+    r->original = malloc((size ? size : 1) * sizeof *r->original);
+    for (size_t v = 0; v < size; ++v)
+    {
+        if (graph_vertex_exists(h, v))
+        {
+            kernel_of[v] = k;
+            r->original[k++] = v;
+        }
+    }
+
+    vertex (*edges)[2] = malloc((m ? m : 1) * sizeof *edges);
+    size_t e = 0;
+    vertex v, w;
+    GRAPH_ITER_EDGES(h, v, w)
+    {
+        edges[e][0] = kernel_of[v];
+        edges[e][1] = kernel_of[w];
+        e++;
+    }
+    assert(e == m);
+    r->kernel = csr_make(k, m, (const vertex (*)[2]) edges);
+    free(edges);
+    free(kernel_of);
+}
+
+struct reduction *reduce_graph(const struct csr *g)
+{
+    struct reduction *r = calloc(1, sizeof *r);
+    struct state s = { NULL, r, 0 };
+    r->g = g;
+    load(&s, g);
+
+    // The block search is the most expensive rule, so it runs only
+    // once the cheap ones are exhausted.
+    for (;;)
+    {
+        if (remove_low_degree(&s) + fold_paths(&s) > 0)
+        {
+            continue;
+        }
+        if (remove_bipartite_blocks(&s) == 0)
+        {
+            break;
+        }
+    }
+
+    compact(&s);
+    graph_free(s.h);
+    return r;
+}
+
+void reduction_free(struct reduction *r)
+{
+    csr_free(r->kernel);
+    free(r->original);
+    free(r->steps);
+    free(r);
+}
+
+size_t reduce_count(const struct reduction *r, enum reduce_rule rule)
+{
+    size_t n = 0;
+    for (size_t i = 0; i < r->num_steps; ++i)
+    {
+        n += r->steps[i].rule == rule;
+    }
+    return n;
+}
+
+/* Only REDUCE_SELF_LOOP steps add to the cover: vertices deleted by the
+   other rules are on no odd cycle once the rest of the cover is gone,
+   or, for folded paths, on none that is not hit by an endpoint.  */
+struct bitvec *reduce_lift(const struct reduction *r, const struct bitvec *cover)
+{
+    struct bitvec *result = bitvec_make(csr_size(r->g));
+    BITVEC_ITER(cover, k)
+    {
+        bitvec_set(result, r->original[k]);
+    }
+    for (size_t i = r->num_steps; i-- > 0;)
+    {
+        switch (r->steps[i].rule)
+        {
+        case REDUCE_SELF_LOOP:
+            bitvec_set(result, r->steps[i].v);
+            break;
+        case REDUCE_LOW_DEGREE:
+        case REDUCE_FOLD:
+        case REDUCE_BIPARTITE_BLOCK:
+        case REDUCE_NUM_RULES:
+            break;
+        }
+    }
+    return result;
+}
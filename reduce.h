@@ -0,0 +1,69 @@
+/* occ -- find minimum odd cycle covers (Graph Bipartization)
+   Copyright (C) 2006 Falk Hueffner
+
+   This program is free software; you can redistribute it and/or
+   modify it under the terms of the GNU General Public License as
+   published by the Free Software Foundation; either version 2 of
+   the License, or (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with GCC; see the file COPYING.  If not, write to the Free
+   Software Foundation, 51 Franklin Street, Fifth Floor, Boston, MA
+   02110-1301, USA.  */
+
+#ifndef REDUCE_H
+#define REDUCE_H
+
+#include <stddef.h>
+
+#include "graph.h"
+
+struct bitvec;
+struct csr;
+
+/* Data reduction rules applied before iterative compression, in the
+   order they are tried.  */
+enum reduce_rule {
+    REDUCE_SELF_LOOP,		// vertex with a self-loop, put into the cover
+    REDUCE_LOW_DEGREE,		// vertex of degree 0 or 1, deleted
+    REDUCE_FOLD,		// inner vertex of a folded degree-2 path
+    REDUCE_BIPARTITE_BLOCK,	// vertex only in bipartite blocks
+    REDUCE_NUM_RULES
+};
+
+/* One entry of the reversal log: rule RULE removed V.  */
+struct reduce_step {
+    enum reduce_rule rule;
+    vertex v;
+};
+
+/* The kernel of a graph together with what it takes to turn a cover
+   of the kernel back into one of the graph.  */
+struct reduction {
+    const struct csr *g;
+    struct csr *kernel;
+    vertex *original;		// kernel vertex -> vertex of G
+    struct reduce_step *steps;
+    size_t num_steps;
+    size_t num_merged;		// parallel edges merged
+};
+
+/* Apply the reduction rules to G until none of them applies any more.
+   The kernel has an odd cycle cover of size k - s exactly if G has one
+   of size k, where s is the number of REDUCE_SELF_LOOP steps.  */
+struct reduction *reduce_graph(const struct csr *g);
+void reduction_free(struct reduction *r);
+
+/* Number of vertices removed by RULE.  */
+size_t reduce_count(const struct reduction *r, enum reduce_rule rule);
+
+/* Return a malloced cover of G made from the cover COVER of the kernel,
+   by walking the reversal log backwards.  */
+struct bitvec *reduce_lift(const struct reduction *r, const struct bitvec *cover);
+
+#endif // REDUCE_H
@@ -0,0 +1,254 @@
+/* occ -- find minimum odd cycle covers (Graph Bipartization)
+   Copyright (C) 2006 Falk Hueffner
+
+   This program is free software; you can redistribute it and/or
+   modify it under the terms of the GNU General Public License as
+   published by the Free Software Foundation; either version 2 of
+   the License, or (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with GCC; see the file COPYING.  If not, write to the Free
+   Software Foundation, 51 Franklin Street, Fifth Floor, Boston, MA
+   02110-1301, USA.  */
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "csr.h"
+#include "relabel.h"
+
+static const char *const order_names[] = {
+    [RELABEL_NONE]   = "none",
+    [RELABEL_BFS]    = "bfs",
+    [RELABEL_RCM]    = "rcm",
+    [RELABEL_DEGREE] = "degree",
+};
+
+bool relabel_parse(const char *name, enum relabel_order *order)
+{
+    for (size_t i = 0; i < sizeof order_names / sizeof *order_names; ++i)
+    {
+        if (strcmp(name, order_names[i]) == 0)
+        {
+            *order = i;
+            return true;
+        }
+    }
+    return false;
+}
+
+const char *relabel_name(enum relabel_order order)
+{
+    return order_names[order];
+}
+
+/* Vertices by increasing degree, stable, by counting sort.  */
+static void sort_by_degree(const struct csr *g, vertex *result)
+{
+    size_t size = csr_size(g), max_degree = 0;
+    for (size_t v = 0; v < size; ++v)
+    {
+        if (csr_degree(g, v) > max_degree)
+        {
+            max_degree = csr_degree(g, v);
+        }
+    }
+
+    size_t *start = calloc(max_degree + 2, sizeof *start);
+    for (size_t v = 0; v < size; ++v)
+    {
+        start[csr_degree(g, v) + 1]++;
+    }
+    for (size_t d = 0; d <= max_degree; ++d)
+    {
+        start[d + 1] += start[d];
+    }
+    for (size_t v = 0; v < size; ++v)
+    {
+        result[start[csr_degree(g, v)]++] = v;
+    }
+    free(start);
+}
+
+struct by_degree {
+    size_t degree;
+    vertex v;
+};
+
+static int by_degree_cmp(const void *p1, const void *p2)
+{
+    const struct by_degree *a = p1, *b = p2;
+    if (a->degree != b->degree)
+    {
+        return a->degree < b->degree ? -1 : 1;
+    }
+    return (a->v > b->v) - (a->v < b->v);
+}
+
+/* Breadth-first search from each of ROOTS in turn that is not yet
+   reached. With BY_DEGREE, the newly reached neighbors of each vertex
+   are queued by increasing degree (Cuthill-McKee).  */
+static void bfs_order(const struct csr *g, const vertex *roots, bool by_degree,
+		      vertex *result)
+{
+    size_t size = csr_size(g);
+    bool *seen = calloc(size ? size : 1, sizeof *seen);
+    struct by_degree *scratch = NULL;
+    if (by_degree)
+    {
+        size_t max_degree = 0;
+        for (size_t v = 0; v < size; ++v)
+        {
+            if (csr_degree(g, v) > max_degree)
+            {
+                max_degree = csr_degree(g, v);
+            }
+        }
+        scratch = malloc((max_degree ? max_degree : 1) * sizeof *scratch);
+    }
+
+    vertex *qhead = result, *qtail = result;
+    for (size_t i = 0; i < size; ++i)
+    {
+        if (seen[roots[i]])
+        {
+            continue;
+        }
+        seen[roots[i]] = true;
+        *qtail++ = roots[i];
+        while (qhead != qtail)
+        {
+            vertex v = *qhead++, w;
+            size_t n = 0;
+            CSR_NEIGHBORS_ITER(g, v, w)
+            {
+                if (!seen[w])
+                {
+                    seen[w] = true;
+                    if (by_degree)
+                    {
+                        scratch[n++] = (struct by_degree) { csr_degree(g, w), w };
+                    }
+                    else
+                    {
+                        *qtail++ = w;
+                    }
+                }
+            }
+            if (by_degree)
+            {
+                qsort(scratch, n, sizeof *scratch, by_degree_cmp);
+                for (size_t j = 0; j < n; ++j)
+                {
+                    *qtail++ = scratch[j].v;
+                }
+            }
+        }
+    }
+
+    free(scratch);
+    free(seen);
+}
+
+vertex *relabel_order(const struct csr *g, enum relabel_order order)
+{
+    size_t size = csr_size(g);
+    vertex *result = malloc((size ? size : 1) * sizeof *result);
+    vertex *roots;
+    switch (order)
+    {
+    case RELABEL_NONE:
+        for (size_t v = 0; v < size; ++v)
+        {
+            result[v] = v;
+        }
+        break;
+
+    case RELABEL_BFS:
+        roots = malloc((size ? size : 1) * sizeof *roots);
+        for (size_t v = 0; v < size; ++v)
+        {
+            roots[v] = v;
+        }
+        bfs_order(g, roots, false, result);
+        free(roots);
+        break;
+
+    case RELABEL_RCM:
+        // Start each component at a vertex of minimum degree.
+        roots = malloc((size ? size : 1) * sizeof *roots);
+        sort_by_degree(g, roots);
+        bfs_order(g, roots, true, result);
+        free(roots);
+        for (size_t i = 0; i < size / 2; ++i)
+        {
+            vertex t = result[i];
+            result[i] = result[size - 1 - i];
+            result[size - 1 - i] = t;
+        }
+        break;
+
+    case RELABEL_DEGREE:
+        sort_by_degree(g, result);
+        for (size_t i = 0; i < size / 2; ++i)
+        {
+            vertex t = result[i];
+            result[i] = result[size - 1 - i];
+            result[size - 1 - i] = t;
+        }
+        break;
+    }
+    return result;
+}
+
+struct csr *relabel_graph(const struct csr *g, const vertex *old_of_new)
+{
+    size_t size = csr_size(g);
+    vertex *new_of_old = malloc((size ? size : 1) * sizeof *new_of_old);
+    for (size_t i = 0; i < size; ++i)
+    {
+        new_of_old[old_of_new[i]] = i;
+    }
+
+    struct csr *r = malloc(sizeof *r);
+    r->size = size;
+    r->offsets = malloc((size + 1) * sizeof *r->offsets);
+    r->neighbors = malloc((g->offsets[size] ? g->offsets[size] : 1) * sizeof *r->neighbors);
+    r->map = NULL;
+    r->map_size = 0;
+
+    r->offsets[0] = 0;
+    for (size_t i = 0; i < size; ++i)
+    {
+        size_t arc = r->offsets[i];
+        vertex w;
+        CSR_NEIGHBORS_ITER(g, old_of_new[i], w)
+        {
+            r->neighbors[arc++] = new_of_old[w];
+        }
+        r->offsets[i + 1] = arc;
+    }
+    free(new_of_old);
+
+    csr_sort_neighbors(r, 1);
+    return r;
+}
+
+double relabel_edge_span(const struct csr *g)
+{
+    double sum = 0;
+    for (size_t v = 0; v < csr_size(g); ++v)
+    {
+        vertex w;
+        CSR_NEIGHBORS_ITER(g, v, w)
+        {
+            sum += v < w ? w - v : v - w;
+        }
+    }
+    return g->offsets[csr_size(g)] ? sum / g->offsets[csr_size(g)] : 0;
+}
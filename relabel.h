@@ -0,0 +1,54 @@
+/* occ -- find minimum odd cycle covers (Graph Bipartization)
+   Copyright (C) 2006 Falk Hueffner
+
+   This program is free software; you can redistribute it and/or
+   modify it under the terms of the GNU General Public License as
+   published by the Free Software Foundation; either version 2 of
+   the License, or (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with GCC; see the file COPYING.  If not, write to the Free
+   Software Foundation, 51 Franklin Street, Fifth Floor, Boston, MA
+   02110-1301, USA.  */
+
+#ifndef RELABEL_H
+#define RELABEL_H
+
+#include <stdbool.h>
+
+#include "graph.h"
+
+struct csr;
+
+/* Vertex orders for renumbering the input graph so that neighbors get
+   nearby numbers, which keeps the BFS in the flow and coloring code
+   within fewer cache lines.  */
+enum relabel_order {
+    RELABEL_NONE,
+    RELABEL_BFS,		// breadth-first search order
+    RELABEL_RCM,		// reverse Cuthill-McKee
+    RELABEL_DEGREE,		// by decreasing degree
+};
+
+/* Set *ORDER from its name ("none", "bfs", "rcm" or "degree"). Returns
+   false for unknown names.  */
+bool relabel_parse(const char *name, enum relabel_order *order);
+const char *relabel_name(enum relabel_order order);
+
+/* Return a malloced array listing the vertices of G in ORDER: entry i
+   is the old number of the vertex that gets number i.  */
+vertex *relabel_order(const struct csr *g, enum relabel_order order);
+
+/* Return G with vertex OLD_OF_NEW[i] renumbered to i. Neighbor lists
+   come out sorted.  */
+struct csr *relabel_graph(const struct csr *g, const vertex *old_of_new);
+
+/* Mean distance between the numbers of adjacent vertices.  */
+double relabel_edge_span(const struct csr *g);
+
+#endif // RELABEL_H
@@ -0,0 +1,120 @@
+/* occ -- find minimum odd cycle covers (Graph Bipartization)
+   Copyright (C) 2006 Falk Hueffner
+
+   This program is free software; you can redistribute it and/or
+   modify it under the terms of the GNU General Public License as
+   published by the Free Software Foundation; either version 2 of
+   the License, or (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with GCC; see the file COPYING.  If not, write to the Free
+   Software Foundation, 51 Franklin Street, Fifth Floor, Boston, MA
+   02110-1301, USA.  */
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "unionfind.h"
+
+struct unionfind *unionfind_make(size_t size)
+{
+    size_t n = size ? size : 1;
+    struct unionfind *uf = malloc(sizeof *uf);
+    uf->size = size;
+    uf->parent = malloc(n * sizeof *uf->parent);
+    uf->count = malloc(n * sizeof *uf->count);
+    uf->parity = malloc(n * sizeof *uf->parity);
+    uf->epoch = 0;
+    uf->stamp = calloc(n, sizeof *uf->stamp);
+    uf->side = malloc(n * sizeof *uf->side);
+    unionfind_reset(uf);
+    return uf;
+}
+
+void unionfind_free(struct unionfind *uf)
+{
+    free(uf->parent);
+    free(uf->count);
+    free(uf->parity);
+    free(uf->stamp);
+    free(uf->side);
+    free(uf);
+}
+
+void unionfind_reset(struct unionfind *uf)
+{
+    for (size_t v = 0; v < uf->size; ++v)
+    {
+        uf->parent[v] = v;
+        uf->count[v] = 1;
+        uf->parity[v] = 0;
+    }
+}
+
+/* Path halving: every other vertex on the path is hooked to its
+   grandparent, folding the parity of the skipped edge into its own.  */
+vertex unionfind_find(struct unionfind *uf, vertex v, bool *parity)
+{
+    assert(v < uf->size);
+    bool p = false;
+    while (uf->parent[v] != v)
+    {
+        vertex u = uf->parent[v];
+        if (uf->parent[u] != u)
+        {
+            uf->parity[v] ^= uf->parity[u];
+            uf->parent[v] = uf->parent[u];
+        }
+        p ^= uf->parity[v];
+        v = uf->parent[v];
+    }
+    *parity = p;
+    return v;
+}
+
+bool unionfind_link(struct unionfind *uf, vertex v, vertex w)
+{
+    bool pv, pw;
+    vertex rv = unionfind_find(uf, v, &pv), rw = unionfind_find(uf, w, &pw);
+    if (rv == rw)
+    {
+        return pv != pw;
+    }
+    if (uf->count[rv] < uf->count[rw])
+    {
+        vertex t = rv;
+        rv = rw;
+        rw = t;
+    }
+    uf->parent[rw] = rv;
+    uf->count[rv] += uf->count[rw];
+    uf->parity[rw] = !(pv ^ pw);
+    return true;
+}
+
+void unionfind_begin(struct unionfind *uf)
+{
+    if (++uf->epoch == 0)
+    {
+        memset(uf->stamp, 0, uf->size * sizeof *uf->stamp);
+        uf->epoch = 1;
+    }
+}
+
+bool unionfind_fits(struct unionfind *uf, vertex w)
+{
+    bool p;
+    vertex r = unionfind_find(uf, w, &p);
+    if (uf->stamp[r] == uf->epoch)
+    {
+        return uf->side[r] == p;
+    }
+    uf->stamp[r] = uf->epoch;
+    uf->side[r] = p;
+    return true;
+}
@@ -0,0 +1,64 @@
+/* occ -- find minimum odd cycle covers (Graph Bipartization)
+   Copyright (C) 2006 Falk Hueffner
+
+   This program is free software; you can redistribute it and/or
+   modify it under the terms of the GNU General Public License as
+   published by the Free Software Foundation; either version 2 of
+   the License, or (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with GCC; see the file COPYING.  If not, write to the Free
+   Software Foundation, 51 Franklin Street, Fifth Floor, Boston, MA
+   02110-1301, USA.  */
+
+#ifndef UNIONFIND_H
+#define UNIONFIND_H
+
+#include <stdbool.h>
+#include <stddef.h>
+
+#include "graph.h"
+
+/* Union-find with parity: every vertex knows whether its color differs
+   from that of its parent, so linking the ends of an edge either keeps
+   a two-coloring of each component or finds an odd cycle. Union by
+   size and path halving.  */
+struct unionfind {
+    size_t size;
+    vertex *parent;
+    vertex *count;		// size of the tree, valid at roots
+    unsigned char *parity;	// color relative to the parent
+    // For unionfind_fits: the color each root was last seen with.
+    unsigned epoch;
+    unsigned *stamp;
+    unsigned char *side;
+};
+
+struct unionfind *unionfind_make(size_t size);
+void unionfind_free(struct unionfind *uf);
+
+/* Make every vertex a component of its own.  */
+void unionfind_reset(struct unionfind *uf);
+
+/* Return the root of V and set *PARITY to the color of V relative to
+   it.  */
+vertex unionfind_find(struct unionfind *uf, vertex v, bool *parity);
+
+/* Record the edge V W, whose ends need different colors. Returns
+   false if they already have the same color, that is, the edge closes
+   an odd cycle.  */
+bool unionfind_link(struct unionfind *uf, vertex v, vertex w);
+
+/* Test whether a new vertex could be linked to the vertices passed to
+   unionfind_fits since the last unionfind_begin, without changing
+   anything: it fits as long as all of them that share a component
+   have the same color.  */
+void unionfind_begin(struct unionfind *uf);
+bool unionfind_fits(struct unionfind *uf, vertex w);
+
+#endif // UNIONFIND_H
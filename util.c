@@ -16,6 +16,7 @@
    Software Foundation, 51 Franklin Street, Fifth Floor, Boston, MA
    02110-1301, USA.  */
 
+#include <pthread.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
@@ -58,3 +59,41 @@ char *dup_str(const char *s)
     memcpy(t, s, len);
     return t;
 }
+
+struct thread_arg
+{
+    void (*fn)(void *, unsigned);
+    void *arg;
+    unsigned i;
+};
+
+static void *thread_main(void *p)
+{
+    struct thread_arg *t = p;
+    t->fn(t->arg, t->i);
+    return NULL;
+}
+
+void run_threads(unsigned n, void (*fn)(void *arg, unsigned i), void *arg)
+{
+    pthread_t tids[n];
+    struct thread_arg args[n];
+    for (unsigned i = 1; i < n; ++i)
+    {
+        args[i] = (struct thread_arg) { fn, arg, i };
+        if (pthread_create(&tids[i], NULL, thread_main, &args[i]) != 0)
+        {
+            // Out of threads: do the work here instead.
+            fn(arg, i);
+            tids[i] = pthread_self();
+        }
+    }
+    fn(arg, 0);
+    for (unsigned i = 1; i < n; ++i)
+    {
+        if (!pthread_equal(tids[i], pthread_self()))
+        {
+            pthread_join(tids[i], NULL);
+        }
+    }
+}
@@ -20,6 +20,7 @@
 #define UTIL_H
 
 #include <stdbool.h>
+#include <stdio.h>
 
 #ifdef __GNUC__
 #define UNUSED __attribute__((unused))
@@ -41,4 +42,8 @@ char *dup_str(const char *s);
    success, or false on EOF or error.  */
 bool get_line(char **lineptr, size_t *n, FILE *stream);
 
+/* Call FN(ARG, i) for i = 0 ... N - 1 on N threads (the calling thread
+   runs i = 0) and wait for all of them to return.  */
+void run_threads(unsigned n, void (*fn)(void *arg, unsigned i), void *arg);
+
 #endif	// UTIL_H
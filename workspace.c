@@ -0,0 +1,92 @@
+/* occ -- find minimum odd cycle covers (Graph Bipartization)
+   Copyright (C) 2006 Falk Hueffner
+
+   This program is free software; you can redistribute it and/or
+   modify it under the terms of the GNU General Public License as
+   published by the Free Software Foundation; either version 2 of
+   the License, or (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with GCC; see the file COPYING.  If not, write to the Free
+   Software Foundation, 51 Franklin Street, Fifth Floor, Boston, MA
+   02110-1301, USA.  */
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "bitvec.h"
+#include "workspace.h"
+
+static void workspace_alloc(struct workspace *ws, size_t size)
+{
+    size_t n = size ? size : 1;
+    ws->capacity = size;
+    ws->epoch = 0;
+    ws->visited = calloc(2 * n, sizeof *ws->visited);
+    ws->seen = calloc(n, sizeof *ws->seen);
+    ws->reached = calloc(n, sizeof *ws->reached);
+    ws->predecessors = malloc(2 * n * sizeof *ws->predecessors);
+    ws->queue = malloc(2 * n * sizeof *ws->queue);
+    ws->back_visited = calloc(2 * n, sizeof *ws->back_visited);
+    ws->successors = malloc(2 * n * sizeof *ws->successors);
+    ws->back_queue = malloc(2 * n * sizeof *ws->back_queue);
+    ws->levels = malloc(2 * n * sizeof *ws->levels);
+    ws->arcs = malloc(2 * n * sizeof *ws->arcs);
+    ws->colors = bitvec_make(size);
+}
+
+static void workspace_release(struct workspace *ws)
+{
+    free(ws->visited);
+    free(ws->seen);
+    free(ws->reached);
+    free(ws->predecessors);
+    free(ws->queue);
+    free(ws->back_visited);
+    free(ws->successors);
+    free(ws->back_queue);
+    free(ws->levels);
+    free(ws->arcs);
+    bitvec_free(ws->colors);
+}
+
+struct workspace *workspace_make(size_t size)
+{
+    struct workspace *ws = malloc(sizeof *ws);
+    workspace_alloc(ws, size);
+    return ws;
+}
+
+void workspace_free(struct workspace *ws)
+{
+    workspace_release(ws);
+    free(ws);
+}
+
+void workspace_reserve(struct workspace *ws, size_t size)
+{
+    if (size > ws->capacity)
+    {
+        workspace_release(ws);
+        workspace_alloc(ws, size > 2 * ws->capacity ? size : 2 * ws->capacity);
+    }
+}
+
+void workspace_begin(struct workspace *ws)
+{
+    // Once the epoch wraps around, old stamps could match again.
+    if (++ws->epoch == 0)
+    {
+        size_t n = ws->capacity ? ws->capacity : 1;
+        memset(ws->visited, 0, 2 * n * sizeof *ws->visited);
+        memset(ws->back_visited, 0, 2 * n * sizeof *ws->back_visited);
+        memset(ws->seen, 0, n * sizeof *ws->seen);
+        memset(ws->reached, 0, n * sizeof *ws->reached);
+        ws->epoch = 1;
+    }
+}
@@ -0,0 +1,76 @@
+/* occ -- find minimum odd cycle covers (Graph Bipartization)
+   Copyright (C) 2006 Falk Hueffner
+
+   This program is free software; you can redistribute it and/or
+   modify it under the terms of the GNU General Public License as
+   published by the Free Software Foundation; either version 2 of
+   the License, or (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with GCC; see the file COPYING.  If not, write to the Free
+   Software Foundation, 51 Franklin Street, Fifth Floor, Boston, MA
+   02110-1301, USA.  */
+
+#ifndef WORKSPACE_H
+#define WORKSPACE_H
+
+#include <stdbool.h>
+#include <stddef.h>
+
+#include "graph.h"
+
+struct bitvec;
+
+/* Scratch buffers for the breadth-first searches in the flow and
+   coloring code, allocated once per solver instead of on the stack
+   for every search. Visited marks are epoch stamps: a search starts
+   with workspace_begin, and an entry counts as marked only if it holds
+   the current epoch, so nothing has to be cleared between searches.
+
+   Arrays indexed by vertex code (2 v + port, see flow.c) have twice
+   as many entries as the per-vertex ones.  */
+struct workspace {
+    size_t capacity;		// vertices the buffers are sized for
+    unsigned epoch;
+    unsigned *visited;		// per vertex code
+    unsigned *seen;		// per vertex
+    unsigned *reached;		// per vertex
+    vertex *predecessors;	// per vertex code
+    vertex *queue;		// per vertex code
+    size_t num_reached;		// codes at the start of QUEUE reached by
+				// the last failed augmentation
+    // Second search tree for bidirectional flow augmentation.
+    unsigned *back_visited;	// per vertex code
+    vertex *successors;		// per vertex code
+    vertex *back_queue;		// per vertex code
+    // Level graph for blocking flows.
+    vertex *levels;		// per vertex code
+    vertex *arcs;		// per vertex code, next arc to try
+    struct bitvec *colors;	// per vertex, for occ_is_occ
+};
+
+struct workspace *workspace_make(size_t size);
+void workspace_free(struct workspace *ws);
+
+/* Make WS large enough for graphs with SIZE vertices.  */
+void workspace_reserve(struct workspace *ws, size_t size);
+
+/* Start a new search: all marks are cleared.  */
+void workspace_begin(struct workspace *ws);
+
+static inline bool workspace_marked(const struct workspace *ws,
+				    const unsigned *stamps, size_t i) {
+    return stamps[i] == ws->epoch;
+}
+
+static inline void workspace_mark(const struct workspace *ws,
+				  unsigned *stamps, size_t i) {
+    stamps[i] = ws->epoch;
+}
+
+#endif // WORKSPACE_H